@@ -1,73 +1,34 @@
 #!/bin/bash
 
-commands=(
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc SIM_FLAGS=+cosim"
-
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc SIM_FLAGS=+cosim"
-
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc SIM_FLAGS=+cosim"
-
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc SIM_FLAGS=+cosim"
-
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=/root/my-chipyard/tests/rvv/isg/riscv_vector_arithmetic_smoke_test.elf SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=SmallBobcatConfig BINARY=/root/my-chipyard/tests/rvv/isg/riscv_vector_ms5_smoke_test.elf SIM_FLAGS=+cosim"
-
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=/root/my-chipyard/tests/rvv/isg/riscv_vector_arithmetic_smoke_test.elf SIM_FLAGS=+cosim"
-  "make -C sims/vcs run-binary-hex CONFIG=MegaBobcatConfig BINARY=/root/my-chipyard/tests/rvv/isg/riscv_vector_ms5_smoke_test.elf SIM_FLAGS=+cosim"
+# Each suite runs concurrently on one simulator build; see scripts/run-regression.py
+
+CYDIR=$(git rev-parse --show-toplevel)
+
+# get helpful utilities
+source $CYDIR/scripts/utils.sh
+
+isa_tests=(
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc"
+)
 
+isg_tests=(
+  "/root/my-chipyard/tests/rvv/isg/riscv_vector_arithmetic_smoke_test.elf"
+  "/root/my-chipyard/tests/rvv/isg/riscv_vector_ms5_smoke_test.elf"
 )
 
 eval "make -C sims/vcs clean"
 
-for cmd in "${commands[@]}"
-do
-  echo "Executing: $cmd"
-  output=$(eval $cmd 2>&1)
-
-  # Extract the last lines of the output using `tail`
-  last_lines=$(echo "$output" | tail -10)
-
-  if [[ $last_lines != *"TestDriver.v"* ]]; then
-    echo "$output"
-    echo "*******************FAILED*******************"
-    echo "Expected '$finish' at the end of the printout, but it was not found."
-    echo "$cmd"
-    exit 1
-  fi
-done
+run_suite vcs run-regression SmallBoomConfig "${isa_tests[@]}"
+run_suite vcs run-regression MegaBoomConfig "${isa_tests[@]}"
+run_suite vcs run-regression SmallBobcatConfig "${isa_tests[@]}" "${isg_tests[@]}"
+run_suite vcs run-regression MegaBobcatConfig "${isa_tests[@]}" "${isg_tests[@]}"
 
 echo "PASSED"
-
-
@@ -33,7 +33,14 @@ ENABLE_CUSTOM_FIRRTL_PASS += $(ENABLE_YOSYS_FLOW)
 HELP_SIMULATION_VARIABLES += \
 "   EXTRA_SIM_FLAGS        = additional runtime simulation flags (passed within +permissive)" \
 "   NUMACTL                = set to '1' to wrap simulator in the appropriate numactl command" \
-"   BREAK_SIM_PREREQ       = when running a binary, doesn't rebuild RTL on source changes"
+"   BREAK_SIM_PREREQ       = when running a binary, doesn't rebuild RTL on source changes" \
+"   LOADMEM_ELF            = set to '1' to have run-binary-hex pass the ELF to +loadmem instead of a hex image" \
+"   REGRESSION_BINARIES    = binaries for run-regression(-debug) (default: BINARY). REGRESSION_LIST names a file of them" \
+"   REGRESSION_JOBS        = simulators run-regression runs at once (default: nproc)" \
+"   REGRESSION_LOADMEM     = 'hex' (default), 'elf' or 'none': how run-regression preloads each binary" \
+"   REGRESSION_EXPECT      = regex a run-regression job's output must match to pass" \
+"   PERF_REGIONS           = set to '1' to record perf_start/perf_end regions to <output>.perf.csv (needs WithPerfRegions)" \
+"   TRACE_COUNTERS         = set to '1' to write per-hart retired-instruction counters to <output>.counters.jsonl (needs WithTraceCounters)"
 
 EXTRA_SIM_FLAGS ?=
 NUMACTL         ?= 0
@@ -45,6 +52,7 @@ HELP_COMMANDS += \
 "   run-binary                  = run [./$(shell basename $(sim))] and log instructions to file" \
 "   run-binary-fast             = run [./$(shell basename $(sim))] and don't log instructions" \
 "   run-binary-debug            = run [./$(shell basename $(sim_debug))] and log instructions and waveform to files" \
+"   run-regression(-debug)      = run REGRESSION_BINARIES concurrently on one simulator build, results in a CSV" \
 "   verilog                     = generate intermediate verilog files from chisel elaboration and firrtl passes" \
 "   firrtl                      = generate intermediate firrtl files from chisel elaboration" \
 "   run-tests                   = run all assembly and benchmark tests" \
@@ -350,25 +358,65 @@ BOOTCODE = $(base_dir)/sims/cosim/bootrom/bootrom
 $(binary_hex): $(firstword $(BINARY)) | $(output_dir)
 	$(base_dir)/scripts/smartelf2hex.sh $(firstword $(BINARY)) > $(binary_hex)
 
+# with LOADMEM_ELF=1 the ELF itself is passed as +loadmem and the hex
+# conversion is skipped. only memory models that read ELF images accept it
+ifeq ($(LOADMEM_ELF),1)
+loadmem_image = $(firstword $(BINARY))
+else
+loadmem_image = $(binary_hex)
+endif
+
 run-binary-hex: check-binary
-run-binary-hex: $(SIM_PREREQ) $(binary_hex) | $(output_dir)
+run-binary-hex: $(SIM_PREREQ) $(loadmem_image) | $(output_dir)
 run-binary-hex: run-binary
 run-binary-hex: override LOADMEM_ADDR = 80000000
-run-binary-hex: override LOADMEM = $(binary_hex)
+run-binary-hex: override LOADMEM = $(loadmem_image)
 run-binary-hex: override SIM_FLAGS += +loadmem=$(LOADMEM) +loadmem_addr=$(LOADMEM_ADDR) +testfile=$(firstword $(BINARY)) +whisper_path=$(WHISPER) +whisper_json_path=$(WHISPER_JSON) +bootcode=$(BOOTCODE)
 run-binary-debug-hex: check-binary
-run-binary-debug-hex: $(SIM_DEBUG_REREQ) $(binary_hex) | $(output_dir)
+run-binary-debug-hex: $(SIM_DEBUG_REREQ) $(loadmem_image) | $(output_dir)
 run-binary-debug-hex: run-binary-debug
 run-binary-debug-hex: override LOADMEM_ADDR = 80000000
-run-binary-debug-hex: override LOADMEM = $(binary_hex)
+run-binary-debug-hex: override LOADMEM = $(loadmem_image)
 run-binary-debug-hex: override SIM_FLAGS += +loadmem=$(LOADMEM) +loadmem_addr=$(LOADMEM_ADDR) +testfile=$(firstword $(BINARY)) +whisper_path=$(WHISPER) +whisper_json_path=$(WHISPER_JSON) +bootcode=$(BOOTCODE)
 run-binary-fast-hex: check-binary
-run-binary-fast-hex: $(SIM_PREREQ) $(binary_hex) | $(output_dir)
+run-binary-fast-hex: $(SIM_PREREQ) $(loadmem_image) | $(output_dir)
 run-binary-fast-hex: run-binary-fast
 run-binary-fast-hex: override LOADMEM_ADDR = 80000000
-run-binary-fast-hex: override LOADMEM = $(binary_hex)
+run-binary-fast-hex: override LOADMEM = $(loadmem_image)
 run-binary-fast-hex: override SIM_FLAGS += +loadmem=$(LOADMEM) +loadmem_addr=$(LOADMEM_ADDR) +testfile=$(firstword $(BINARY)) +whisper_path=$(WHISPER) +whisper_json_path=$(WHISPER_JSON) +bootcode=$(BOOTCODE)
 
+#########################################################################################
+# run many binaries concurrently against one simulator build
+#########################################################################################
+REGRESSION_BINARIES ?= $(BINARY)
+REGRESSION_JOBS ?= $(shell nproc)
+REGRESSION_LOADMEM ?= hex
+REGRESSION_EXPECT ?=
+regression_dir = $(output_dir)/regression
+# the same flags the run-binary-*-hex targets add; +loadmem is added per
+# binary, ahead of the --sim-end that closes the permissive window
+regression_loadmem_flags = $(if $(filter none,$(REGRESSION_LOADMEM)),,+loadmem_addr=80000000 +whisper_path=$(WHISPER) +whisper_json_path=$(WHISPER_JSON) +bootcode=$(BOOTCODE))
+regression_args = --jobs $(REGRESSION_JOBS) --loadmem $(REGRESSION_LOADMEM) \
+	$(if $(filter $(NUMACTL),0),,--numa) \
+	$(if $(REGRESSION_EXPECT),--expect '$(REGRESSION_EXPECT)',) \
+	$(if $(REGRESSION_LIST),--list $(REGRESSION_LIST),)
+
+# each job runs in its own directory, so per-run outputs (waveforms,
+# PERF_REGIONS, TRACE_COUNTERS) get a relative name
+run-regression run-regression-debug: sim_out_name = sim
+
+run-regression: $(SIM_PREREQ) | $(output_dir)
+	$(base_dir)/scripts/run-regression.py $(regression_args) --out-dir $(regression_dir) \
+		--sim "$(sim) $(PERMISSIVE_ON) $(SIM_FLAGS) $(EXTRA_SIM_FLAGS) $(SEED_FLAG) $(regression_loadmem_flags)" \
+		--sim-end "$(PERMISSIVE_OFF)" \
+		$(REGRESSION_BINARIES)
+
+run-regression-debug: $(SIM_DEBUG_PREREQ) | $(output_dir)
+	$(base_dir)/scripts/run-regression.py $(regression_args) --out-dir $(regression_dir)-debug \
+		--sim "$(sim_debug) $(PERMISSIVE_ON) $(SIM_FLAGS) $(EXTRA_SIM_FLAGS) $(SEED_FLAG) $(VERBOSE_FLAGS) $(WAVEFORM_FLAG) $(regression_loadmem_flags)" \
+		--sim-end "$(PERMISSIVE_OFF)" \
+		$(REGRESSION_BINARIES)
+
 #########################################################################################
 # run assembly/benchmarks rules
 #########################################################################################
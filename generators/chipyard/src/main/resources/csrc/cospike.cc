@@ -5,6 +5,8 @@
 #include <svdpi.h>
 #include <sstream>
 #include <set>
+#include <mutex>
+#include "harness_profile.h"
 
 #define CLINT_BASE (0x2000000)
 #define CLINT_SIZE (0x1000)
@@ -24,6 +26,9 @@ reg_t tohost_addr = 0;
 reg_t fromhost_addr = 0;
 std::set<reg_t> magic_addrs;
 cfg_t* cfg;
+// One spike instance checks every hart, so harts evaluated on different
+// Verilator threads take turns
+static std::mutex cosim_lock;
 
 static std::vector<std::pair<reg_t, mem_t*>> make_mems(const std::vector<mem_cfg_t> &layout)
 {
@@ -40,6 +45,8 @@ extern "C" void cospike_set_sysinfo(char* isa, int pmpregions,
                                     int nharts,
                                     char* bootrom
                                     ) {
+  // Every hart's monitor calls this on its first cycle out of reset
+  std::lock_guard<std::mutex> guard(cosim_lock);
   if (!info) {
     info = new system_info_t;
     info->isa = std::string(isa);
@@ -66,6 +73,8 @@ extern "C" void cospike_cosim(long long int cycle,
                               unsigned long long int cause,
                               unsigned long long int wdata)
 {
+  harness_profile_scope_t prof(PROFILE_COSPIKE);
+  std::lock_guard<std::mutex> guard(cosim_lock);
   assert(info);
   if (!sim) {
     printf("Configuring spike cosim\n");
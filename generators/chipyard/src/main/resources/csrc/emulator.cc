@@ -8,13 +8,24 @@
 #else
 #include "verilated.h"
 #include "verilated_vcd_c.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #endif // CY_FST_TRACE
 #endif // VM_TRACE
+#if CY_SAVABLE
+#include "verilated_save.h"
+#endif
 #include <fesvr/dtm.h>
 #include <fesvr/tsi.h>
 #include "remote_bitbang.h"
+#include "harness_profile.h"
 #include <iostream>
+#include <string>
+#include <vector>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -54,6 +65,213 @@ double sc_time_stamp()
   return trace_count;
 }
 
+#if VM_TRACE && !CY_FST_TRACE
+// VCD sink that hands the text produced by tfp->dump() to a writer thread,
+// so file I/O overlaps with eval. Output is batched into 1 MiB buffers and
+// at most 8 are queued; past that the simulation waits for the writer.
+// (FST builds get the same effect from Verilator's --trace-threads.)
+class VerilatedVcdThreadedFILE : public VerilatedVcdFile {
+public:
+  VerilatedVcdThreadedFILE(FILE* file) : file(file), stopping(false) {
+    if (file)
+      writer = std::thread(&VerilatedVcdThreadedFILE::writer_main, this);
+  }
+  ~VerilatedVcdThreadedFILE() { close(); }
+  bool open(const std::string& name) override { return true; }
+  void close() override {
+    if (!writer.joinable())
+      return;
+    submit();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+    }
+    cv.notify_all();
+    writer.join();
+    fflush(file);
+  }
+  ssize_t write(const char* bufp, ssize_t len) override {
+    current.append(bufp, len);
+    if (current.size() >= BUFFER_BYTES)
+      submit();
+    return len;
+  }
+private:
+  void submit() {
+    if (current.empty())
+      return;
+    std::unique_lock<std::mutex> guard(lock);
+    cv.wait(guard, [this] { return pending.size() < MAX_PENDING; });
+    pending.push_back(std::move(current));
+    current.clear();
+    current.reserve(BUFFER_BYTES);
+    guard.unlock();
+    cv.notify_all();
+  }
+  void writer_main() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+      cv.wait(guard, [this] { return stopping || !pending.empty(); });
+      if (pending.empty())
+        return;
+      std::string buf = std::move(pending.front());
+      pending.pop_front();
+      guard.unlock();
+      cv.notify_all();
+      fwrite(buf.data(), 1, buf.size(), file);
+      guard.lock();
+    }
+  }
+
+  static const size_t BUFFER_BYTES = 1 << 20;
+  static const size_t MAX_PENDING = 8;
+  FILE* file;
+  std::string current;
+  std::deque<std::string> pending;
+  std::mutex lock;
+  std::condition_variable cv;
+  std::thread writer;
+  bool stopping;
+};
+#endif
+
+// Verilator detects a rising clock by comparing against the clock value it
+// saw on the previous eval. When the generated model exposes that value,
+// --posedge-only clears it in place of evaluating the falling edge. Returns
+// false if the model hides it. Verilator before 4.210 keeps it in the model
+// class, 4.210 to 4.228 in the root module, and 5 under another name; only
+// one of these overloads applies to a given model.
+template <class T>
+static auto clear_last_clock(T *tile, int) -> decltype(tile->__Vclklast__TOP__clock = 0, true)
+{
+  tile->__Vclklast__TOP__clock = 0;
+  return true;
+}
+
+template <class T>
+static auto clear_last_clock(T *tile, long) -> decltype(tile->rootp->__Vclklast__TOP__clock = 0, true)
+{
+  tile->rootp->__Vclklast__TOP__clock = 0;
+  return true;
+}
+
+template <class T>
+static auto clear_last_clock(T *tile, long) -> decltype(tile->rootp->__Vtrigprevexpr___TOP__clock__0 = 0, true)
+{
+  tile->rootp->__Vtrigprevexpr___TOP__clock__0 = 0;
+  return true;
+}
+
+template <class T>
+static bool clear_last_clock(T *tile, ...)
+{
+  return false;
+}
+
+// Snapshot of the +profile counters. Intervals and the final summary are
+// differences between two snapshots.
+struct profile_sample_t {
+  uint64_t cycle;
+  uint64_t wall_ns;
+  uint64_t ns[PROFILE_NCOMPONENTS];
+};
+
+static profile_sample_t profile_sample()
+{
+  profile_sample_t sample;
+  sample.cycle = trace_count;
+  sample.wall_ns = harness_profile_now();
+  for (int i = 0; i < PROFILE_NCOMPONENTS; i++)
+    sample.ns[i] = harness_profile_ns[i].load(std::memory_order_relaxed);
+  return sample;
+}
+
+static void profile_csv_header(FILE *csv)
+{
+  fprintf(csv, "cycle,wall_s,cycles_per_s");
+  for (int i = 0; i < PROFILE_NCOMPONENTS; i++)
+    fprintf(csv, ",%s_s", harness_profile_names[i]);
+  fprintf(csv, "\n");
+}
+
+static void profile_csv_row(FILE *csv, const profile_sample_t &from, const profile_sample_t &to)
+{
+  double wall = (to.wall_ns - from.wall_ns) * 1e-9;
+  fprintf(csv, "%" PRIu64 ",%.6f,%.1f", to.cycle, wall,
+          wall > 0 ? (to.cycle - from.cycle) / wall : 0.0);
+  for (int i = 0; i < PROFILE_NCOMPONENTS; i++)
+    fprintf(csv, ",%.6f", (to.ns[i] - from.ns[i]) * 1e-9);
+  fprintf(csv, "\n");
+  fflush(csv);
+}
+
+static void profile_summary(const profile_sample_t &from, const profile_sample_t &to)
+{
+  double wall = (to.wall_ns - from.wall_ns) * 1e-9;
+  uint64_t cycles = to.cycle - from.cycle;
+  double t[PROFILE_NCOMPONENTS];
+  double dpi = 0;
+  for (int i = 0; i < PROFILE_NCOMPONENTS; i++) {
+    t[i] = (to.ns[i] - from.ns[i]) * 1e-9;
+    if (i > PROFILE_TRACE)
+      dpi += t[i];
+  }
+  auto line = [wall](const char *name, double secs) {
+    fprintf(stderr, "  %-12s %10.3f s %6.1f%%\n", name, secs, wall > 0 ? 100 * secs / wall : 0.0);
+  };
+  fprintf(stderr, "*** PROFILE *** %" PRIu64 " cycles in %.3f s (%.1f cycles/s)\n",
+          cycles, wall, wall > 0 ? cycles / wall : 0.0);
+  // DPI models run inside eval(), so they are listed under it
+  line("eval", t[PROFILE_EVAL]);
+  line("  model", t[PROFILE_EVAL] - dpi);
+  for (int i = PROFILE_TRACE + 1; i < PROFILE_NCOMPONENTS; i++)
+    line((std::string("  ") + harness_profile_names[i]).c_str(), t[i]);
+  line("trace", t[PROFILE_TRACE]);
+  line("other", wall - t[PROFILE_EVAL] - t[PROFILE_TRACE]);
+}
+
+#if CY_SAVABLE
+// A snapshot is the harness cycle count followed by the Verilated model.
+// It is written under a private name and renamed, so that a reader never
+// sees a partial file.
+static void save_model(TEST_HARNESS *tile, const char *fname)
+{
+  std::string tmp = std::string(fname) + "." + std::to_string(getpid());
+  VerilatedSave os;
+  os.open(tmp.c_str());
+  os << trace_count;
+  os << *tile;
+  os.close();
+  if (rename(tmp.c_str(), fname) != 0) {
+    fprintf(stderr, "Unable to write snapshot %s\n", fname);
+    unlink(tmp.c_str());
+  }
+}
+
+#if VERILATOR_VERSION_INTEGER >= 4210000
+// The model's initial blocks, generated as a function of its root module
+#define CY_CAT_(a, b) a##b
+#define CY_CAT(a, b) CY_CAT_(a, b)
+#define TEST_HARNESS_ROOT CY_CAT(TEST_HARNESS, ___024root)
+void CY_CAT(TEST_HARNESS_ROOT, ___eval_initial)(TEST_HARNESS_ROOT *vlSelf);
+#endif
+
+static void restore_model(TEST_HARNESS *tile, const char *fname)
+{
+  VerilatedRestore is;
+  is.open(fname);
+  is >> trace_count;
+  is >> *tile;
+  is.close();
+#if VERILATOR_VERSION_INTEGER >= 4210000
+  // A restored model counts as initialized, so Verilator would not run its
+  // initial blocks in this process. DPI models such as SimDRAM set up their
+  // C++ state there (and keep a chandle to it), so run them again.
+  CY_CAT(TEST_HARNESS_ROOT, ___eval_initial)(tile->rootp);
+#endif
+}
+#endif
+
 static void usage(const char * program_name)
 {
   printf("Usage: %s [EMULATOR OPTION]... [VERILOG PLUSARG]... [HOST OPTION]... BINARY [TARGET OPTION]...\n",
@@ -71,11 +289,28 @@ EMULATOR OPTIONS\n\
        +max-cycles=CYCLES\n\
   -s, --seed=SEED          Use random number seed SEED\n\
   -r, --rbb-port=PORT      Use PORT for remote bit bang (with OpenOCD and GDB) \n\
-                           If not specified, a random port will be chosen\n\
-                           automatically.\n\
+                           If not specified, the server is only started when\n\
+                           +jtag_rbb_enable=1 is set, on a random port.\n\
   -V, --verbose            Enable all Chisel printfs (cycle-by-cycle info)\n\
        +verbose\n\
+      --posedge-only       Skip the falling-edge eval after reset. Only for\n\
+       +posedge-only       designs without negedge logic or clock-level latches\n\
+      --poll-interval=N    Check the DTM/JTAG/TSI hosts for completion every N\n\
+       +poll-interval=N    cycles (default 64)\n\
+      --profile            Print where host time went (eval, DPI models,\n\
+       +profile            tracing) and cycles per second at exit\n\
+      --profile-csv=FILE   Also write the breakdown to FILE every\n\
+       +profile-csv=FILE   --profile-interval cycles\n\
+      --profile-interval=N Cycles per --profile-csv row (default 1000000)\n\
+       +profile-interval=N\n\
+", stdout);
+#if CY_SAVABLE
+  fputs("\
+      --reset-snapshot=FILE  Restore the model from FILE instead of running\n\
+       +reset-snapshot=FILE  reset, or run reset and save it to FILE if FILE\n\
+                           does not exist yet\n\
 ", stdout);
+#endif
 #if VM_TRACE == 0
   fputs("\
 \n\
@@ -86,6 +321,11 @@ EMULATOR DEBUG OPTIONS (only supported in debug build -- try `make debug`)\n",
   -v, --vcd=FILE,          Write vcd trace to FILE (or '-' for stdout)\n\
   -x, --dump-start=CYCLE   Start VCD tracing at CYCLE\n\
        +dump-start\n\
+      --dump-end=CYCLE     Stop VCD tracing at CYCLE and close the file\n\
+       +dump-end\n\
+      --trace-scope=SCOPE  Only trace the hierarchy under SCOPE (e.g.\n\
+       +trace-scope=SCOPE  TestHarness.chiptop0.system); may be repeated\n\
+                           or given a comma-separated list\n\
 ", stdout);
   fputs("\n" PLUSARG_USAGE_OPTIONS, stdout);
   fputs("\n" HTIF_USAGE_OPTIONS, stdout);
@@ -114,12 +354,23 @@ int main(int argc, char** argv)
   uint64_t max_cycles = -1;
   int ret = 0;
   bool print_cycles = false;
+  bool posedge_only = false;
+  uint64_t poll_interval = 64;
+  bool profile = false;
+  FILE * profile_csv = NULL;
+  uint64_t profile_interval = 1000000;
   // Port numbers are 16 bit unsigned integers.
   uint16_t rbb_port = 0;
+  bool rbb_requested = false;
 #if VM_TRACE
   const char* vcdfile_name = NULL;
   FILE * vcdfile = NULL;
   uint64_t start = 0;
+  uint64_t end = -1;
+  std::vector<std::string> trace_scopes;
+#endif
+#if CY_SAVABLE
+  const char* reset_snapshot = NULL;
 #endif
   int verilog_plusargs_legal = 1;
 
@@ -139,9 +390,19 @@ int main(int argc, char** argv)
       {"verbose",         no_argument,       0, 'V' },
       {"permissive",      no_argument,       0, 'p' },
       {"permissive-off",  no_argument,       0, 'o' },
+      {"posedge-only",    no_argument,       0, 'n' },
+      {"poll-interval",   required_argument, 0, 'i' },
+      {"profile",         no_argument,       0, 'f' },
+      {"profile-csv",     required_argument, 0, 'F' },
+      {"profile-interval", required_argument, 0, 'I' },
 #if VM_TRACE
       {"vcd",             required_argument, 0, 'v' },
       {"dump-start",      required_argument, 0, 'x' },
+      {"dump-end",        required_argument, 0, 'e' },
+      {"trace-scope",     required_argument, 0, 'S' },
+#endif
+#if CY_SAVABLE
+      {"reset-snapshot",  required_argument, 0, 'R' },
 #endif
       HTIF_LONG_OPTIONS
     };
@@ -160,10 +421,26 @@ int main(int argc, char** argv)
       case 'h': usage(argv[0]);             return 0;
       case 'm': max_cycles = atoll(optarg); break;
       case 's': random_seed = atoi(optarg); break;
-      case 'r': rbb_port = atoi(optarg);    break;
+      case 'r':
+        rbb_port = atoi(optarg);
+        rbb_requested = true;
+        break;
       case 'V': verbose = true;             break;
       case 'p': opterr = 0;                 break;
       case 'o': opterr = 1;                 break;
+      case 'n': posedge_only = true;        break;
+      case 'i': poll_interval = atoll(optarg); break;
+      case 'f': profile = true;             break;
+      case 'F': {
+        profile = true;
+        profile_csv = fopen(optarg, "w");
+        if (!profile_csv) {
+          std::cerr << "Unable to open " << optarg << " for profile write\n";
+          return 1;
+        }
+        break;
+      }
+      case 'I': profile_interval = atoll(optarg); break;
 #if VM_TRACE
       case 'v': {
         vcdfile_name = optarg;
@@ -175,6 +452,27 @@ int main(int argc, char** argv)
         break;
       }
       case 'x': start = atoll(optarg);      break;
+      case 'e': end = atoll(optarg);        break;
+      case 'S': {
+        std::string scopes = optarg;
+        size_t pos = 0;
+        while (pos <= scopes.size()) {
+          size_t comma = scopes.find(',', pos);
+          if (comma == std::string::npos)
+            comma = scopes.size();
+          if (comma > pos)
+            trace_scopes.push_back(scopes.substr(pos, comma - pos));
+          pos = comma + 1;
+        }
+        if (trace_scopes.empty()) {
+          fprintf(stderr, "+trace-scope names no scope\n");
+          return 1;
+        }
+        break;
+      }
+#endif
+#if CY_SAVABLE
+      case 'R': reset_snapshot = optarg;    break;
 #endif
       // Process legacy '+' EMULATOR arguments by replacing them with
       // their getopt equivalents
@@ -195,7 +493,37 @@ int main(int argc, char** argv)
           c = 'x';
           optarg = optarg+12;
         }
+        else if (arg.substr(0, 10) == "+dump-end=") {
+          c = 'e';
+          optarg = optarg+10;
+        }
+        else if (arg.substr(0, 13) == "+trace-scope=") {
+          c = 'S';
+          optarg = optarg+13;
+        }
+#endif
+#if CY_SAVABLE
+        else if (arg.substr(0, 16) == "+reset-snapshot=") {
+          c = 'R';
+          optarg = optarg+16;
+        }
 #endif
+        else if (arg == "+posedge-only")
+          c = 'n';
+        else if (arg.substr(0, 15) == "+poll-interval=") {
+          c = 'i';
+          optarg = optarg+15;
+        }
+        else if (arg == "+profile")
+          c = 'f';
+        else if (arg.substr(0, 13) == "+profile-csv=") {
+          c = 'F';
+          optarg = optarg+13;
+        }
+        else if (arg.substr(0, 18) == "+profile-interval=") {
+          c = 'I';
+          optarg = optarg+18;
+        }
         else if (arg.substr(0, 12) == "+cycle-count")
           c = 'c';
         else if (arg == "+permissive")
@@ -273,6 +601,24 @@ done_processing:
   // Copy remaining HTIF arguments (if any) and the binary file name into the verilator argument stack
   while (optind < argc) verilated_argv[verilated_argc++] = argv[optind++];
 
+#if CY_CLOCK_GATES
+  // Set at build time when the model has EICG_wrapper clock gates. Their
+  // latch is transparent while the clock is low, which --posedge-only skips.
+  if (posedge_only) {
+    fprintf(stderr, "+posedge-only is not supported by this model: its EICG_wrapper clock gates "
+            "latch while the clock is low\n");
+    return 1;
+  }
+#endif
+#if CY_SAVABLE
+#if VERILATOR_VERSION_INTEGER < 4210000
+  if (reset_snapshot) {
+    fprintf(stderr, "+reset-snapshot needs Verilator 4.210 or newer\n");
+    return 1;
+  }
+#endif
+#endif
+
   if (verbose)
     fprintf(stderr, "using random seed %u\n", random_seed);
 
@@ -288,74 +634,192 @@ done_processing:
 #if CY_FST_TRACE
   std::unique_ptr<VerilatedFstC> tfp(new VerilatedFstC);
 #else
-  std::unique_ptr<VerilatedVcdFILE> vcdfd(new VerilatedVcdFILE(vcdfile));
+  std::unique_ptr<VerilatedVcdThreadedFILE> vcdfd(new VerilatedVcdThreadedFILE(vcdfile));
   std::unique_ptr<VerilatedVcdC> tfp(new VerilatedVcdC(vcdfd.get()));
 #endif // CY_FST_TRACE
   if (vcdfile_name) {
+    // Signals outside the selected scopes are never declared, so they cost
+    // neither file space nor change detection
+    for (std::string scope : trace_scopes) {
+      if (scope.find_first_of("*?[") != std::string::npos) {
+        fprintf(stderr, "+trace-scope takes hierarchy prefixes, not globs (%s); "
+                "use TRACE_SCOPE in sims/verilator to expand a glob\n", scope.c_str());
+        return 1;
+      }
+#if VERILATOR_VERSION_INTEGER >= 5010000
+      // Verilator names the root scope TOP
+      if (scope != "TOP" && scope.substr(0, 4) != "TOP.")
+        scope = "TOP." + scope;
+      tfp->dumpvars(99, scope);
+#else
+      fprintf(stderr, "+trace-scope needs Verilator 5.010 or newer\n");
+      return 1;
+#endif
+    }
     tile->trace(tfp.get(), 99);  // Trace 99 levels of hierarchy
     tfp->open(vcdfile_name);
   }
 #endif // VM_TRACE
 
-  // RocketChip currently only supports RBB port 0, so this needs to stay here
-  jtag = new remote_bitbang_t(rbb_port);
+  // Without an explicit port, SimJTAG creates the server on its first tick,
+  // which only happens with +jtag_rbb_enable=1
+  if (rbb_requested)
+    jtag = new remote_bitbang_t(rbb_port);
 
   signal(SIGTERM, handle_sigterm);
 
   bool dump;
-  // start reset off low so a rising edge triggers async reset
-  tile->reset = 0;
-  tile->clock = 0;
-  tile->eval();
-  // reset for several cycles to handle pipelined reset
-  for (int i = 0; i < 100; i++) {
-    tile->reset = 1;
+  bool restored = false;
+#if VM_TRACE
+  bool tracing = vcdfile_name != NULL;
+#endif
+#if CY_SAVABLE
+  // A reset snapshot is taken before the DPI models set up anything but
+  // what their initial blocks do, which restore_model runs again. The rest
+  // set up on the first cycle out of reset, and fesvr only loads the binary
+  // after that, so one snapshot serves every binary.
+  if (reset_snapshot && access(reset_snapshot, R_OK) == 0) {
+    restore_model(tile, reset_snapshot);
+    restored = true;
+  }
+#endif
+  if (!restored) {
+    // start reset off low so a rising edge triggers async reset
+    tile->reset = 0;
     tile->clock = 0;
     tile->eval();
+    // reset for several cycles to handle pipelined reset
+    for (int i = 0; i < 100; i++) {
+      tile->reset = 1;
+      tile->clock = 0;
+      tile->eval();
 #if VM_TRACE
-    dump = tfp && trace_count >= start;
-    if (dump)
-      tfp->dump(static_cast<vluint64_t>(trace_count * 2));
+      dump = tracing && trace_count >= start && trace_count < end;
+      if (dump)
+        tfp->dump(static_cast<vluint64_t>(trace_count * 2));
 #endif
-    tile->clock = 1;
-    tile->eval();
+      tile->clock = 1;
+      tile->eval();
 #if VM_TRACE
-    if (dump)
-      tfp->dump(static_cast<vluint64_t>(trace_count * 2 + 1));
+      if (dump)
+        tfp->dump(static_cast<vluint64_t>(trace_count * 2 + 1));
+#endif
+      trace_count ++;
+    }
+#if CY_SAVABLE
+    if (reset_snapshot)
+      save_model(tile, reset_snapshot);
 #endif
-    trace_count ++;
   }
   tile->reset = 0;
   done_reset = true;
 
-  do {
-    tile->clock = 0;
+  if (poll_interval == 0)
+    poll_interval = 1;
+  // The fesvr hosts are only asked whether they are done every
+  // poll_interval cycles; io_success and max_cycles are checked every cycle
+  uint64_t next_poll = trace_count + 1;
+  auto hosts_running = [&]() {
+    if (trace_count < next_poll)
+      return true;
+    next_poll = trace_count + poll_interval;
+    return (!dtm || !dtm->done()) &&
+           (!jtag || !jtag->done()) &&
+           (!tsi || !tsi->done());
+  };
+
+  if (posedge_only && !clear_last_clock(tile, 0)) {
+    fprintf(stderr, "This Verilator model does not expose its clock edge state, ignoring +posedge-only\n");
+    posedge_only = false;
+  }
+
+  // Reset is not profiled. Both helpers cost a predictable branch when
+  // +profile is off.
+  auto eval = [&]() {
+    harness_profile_scope_t prof(PROFILE_EVAL);
     tile->eval();
+  };
 #if VM_TRACE
-    dump = tfp && trace_count >= start;
-    if (dump)
-      tfp->dump(static_cast<vluint64_t>(trace_count * 2));
+  auto dump_at = [&](vluint64_t time) {
+    harness_profile_scope_t prof(PROFILE_TRACE);
+    tfp->dump(time);
+  };
 #endif
+  profile_sample_t profile_start, profile_last;
+  uint64_t next_profile = -1;
+  if (profile) {
+    harness_profile_enabled = true;
+    profile_start = profile_last = profile_sample();
+    if (profile_csv) {
+      if (profile_interval == 0)
+        profile_interval = 1;
+      profile_csv_header(profile_csv);
+      next_profile = trace_count + profile_interval;
+    }
+  }
+
+  do {
+    if (posedge_only) {
+      clear_last_clock(tile, 0);
+#if VM_TRACE
+      dump = tracing && trace_count >= start && trace_count < end;
+#endif
+    } else {
+      tile->clock = 0;
+      eval();
+#if VM_TRACE
+      dump = tracing && trace_count >= start && trace_count < end;
+      if (dump)
+        dump_at(static_cast<vluint64_t>(trace_count * 2));
+#endif
+    }
 
     tile->clock = 1;
-    tile->eval();
+    eval();
 #if VM_TRACE
     if (dump)
-      tfp->dump(static_cast<vluint64_t>(trace_count * 2 + 1));
+      dump_at(static_cast<vluint64_t>(trace_count * 2 + 1));
 #endif
     trace_count++;
+#if VM_TRACE
+    // Close the trace at +dump-end, so it is complete even if the run is
+    // then cut short
+    if (tracing && trace_count >= end) {
+      tfp->close();
+      tracing = false;
+    }
+#endif
+    if (trace_count >= next_profile) {
+      profile_sample_t sample = profile_sample();
+      profile_csv_row(profile_csv, profile_last, sample);
+      profile_last = sample;
+      next_profile = trace_count + profile_interval;
+    }
   }
   // for verilator multithreading. need to do 1 loop before checking if
   // tsi exists, since tsi is created by verilated thread on the first
   // serial_tick.
-  while ((!dtm || !dtm->done()) &&
-         (!jtag || !jtag->done()) &&
-         (!tsi || !tsi->done()) &&
-         !tile->io_success && trace_count < max_cycles);
+  while (!tile->io_success && trace_count < max_cycles && hosts_running());
+
+  // Run Verilog final blocks, which DPI models use for end-of-run reports
+  tile->final();
+
+  if (profile) {
+    profile_sample_t sample = profile_sample();
+    if (profile_csv) {
+      if (sample.cycle != profile_last.cycle)
+        profile_csv_row(profile_csv, profile_last, sample);
+      fclose(profile_csv);
+    }
+    profile_summary(profile_start, sample);
+  }
 
 #if VM_TRACE
-  if (tfp)
+  if (tfp && tfp->isOpen())
     tfp->close();
+#if !CY_FST_TRACE
+  vcdfd->close();
+#endif
   if (vcdfile)
     fclose(vcdfile);
 #endif
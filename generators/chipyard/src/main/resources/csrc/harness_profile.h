@@ -0,0 +1,55 @@
+// See LICENSE.Berkeley for license details.
+
+#ifndef HARNESS_PROFILE_H
+#define HARNESS_PROFILE_H
+
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+
+// Host-time accounting for the Verilator harness (+profile). The harness
+// charges time spent in eval() and trace dumping; DPI models charge their
+// own entry points, which is a subset of the eval() time. Nothing is
+// measured unless the harness sets harness_profile_enabled, so models
+// built into other simulators pay one branch per call.
+enum harness_profile_component_t {
+  PROFILE_EVAL,
+  PROFILE_TRACE,
+  PROFILE_COSPIKE,
+  PROFILE_SPIKETILE,
+  PROFILE_NCOMPONENTS
+};
+
+inline const char* const harness_profile_names[PROFILE_NCOMPONENTS] = {
+  "eval", "trace", "cospike", "spiketile"
+};
+
+inline bool harness_profile_enabled = false;
+// DPI calls may come from several Verilator threads
+inline std::atomic<uint64_t> harness_profile_ns[PROFILE_NCOMPONENTS];
+
+static inline uint64_t harness_profile_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Charges the lifetime of the object to one component
+class harness_profile_scope_t
+{
+public:
+  harness_profile_scope_t(harness_profile_component_t component) :
+    component(component),
+    start(harness_profile_enabled ? harness_profile_now() : 0) {}
+  ~harness_profile_scope_t() {
+    if (start)
+      harness_profile_ns[component].fetch_add(harness_profile_now() - start,
+                                              std::memory_order_relaxed);
+  }
+private:
+  harness_profile_component_t component;
+  uint64_t start;
+};
+
+#endif
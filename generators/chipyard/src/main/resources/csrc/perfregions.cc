@@ -0,0 +1,187 @@
+#include <elf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vpi_user.h>
+#include <svdpi.h>
+
+// Performance regions for PerfRegionMonitor. With +perf-regions=FILE, every
+// pass from the region start PC to the end PC is written to FILE as one
+// CSV row with its cycle and retired-instruction counts. The PCs are the
+// __perf_start/__perf_end (or perf_start/perf_end) symbols of the binary
+// being run, or +perf-start=/+perf-end= (hex) if given.
+
+struct hart_region_t {
+  bool open = false;
+  uint64_t start_cycle;
+  uint64_t start_instret;
+  int count = 0;
+};
+
+static bool regions_configured = false;
+static FILE* regions_file = NULL;
+static uint64_t region_start_pc = 0;
+static uint64_t region_end_pc = 0;
+static std::map<int, hart_region_t> hart_regions;
+// Monitors of different harts may be evaluated on different threads
+static std::mutex regions_lock;
+
+template <class ehdr_t, class shdr_t, class sym_t>
+static void find_symbols(const uint8_t* image, size_t fsize,
+                         std::map<std::string, uint64_t>& symbols)
+{
+  const ehdr_t* eh = (const ehdr_t*)image;
+  if (fsize < sizeof(ehdr_t) || eh->e_shoff + (uint64_t)eh->e_shnum * sizeof(shdr_t) > fsize)
+    return;
+  const shdr_t* sh = (const shdr_t*)(image + eh->e_shoff);
+  for (int i = 0; i < eh->e_shnum; i++) {
+    if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum)
+      continue;
+    const shdr_t& strtab = sh[sh[i].sh_link];
+    if (sh[i].sh_offset + sh[i].sh_size > fsize || strtab.sh_offset + strtab.sh_size > fsize)
+      continue;
+    const sym_t* syms = (const sym_t*)(image + sh[i].sh_offset);
+    const char* strs = (const char*)(image + strtab.sh_offset);
+    for (size_t j = 0; j < sh[i].sh_size / sizeof(sym_t); j++) {
+      if (syms[j].st_name < strtab.sh_size)
+        symbols[strs + syms[j].st_name] = syms[j].st_value;
+    }
+  }
+}
+
+static std::map<std::string, uint64_t> read_symbols(const char* fname)
+{
+  std::map<std::string, uint64_t> symbols;
+  int fd = open(fname, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size < EI_NIDENT) {
+    if (fd >= 0)
+      close(fd);
+    return symbols;
+  }
+  void* image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (image == MAP_FAILED)
+    return symbols;
+  const uint8_t* ident = (const uint8_t*)image;
+  if (memcmp(ident, ELFMAG, SELFMAG) == 0) {
+    if (ident[EI_CLASS] == ELFCLASS64)
+      find_symbols<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(ident, st.st_size, symbols);
+    else
+      find_symbols<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(ident, st.st_size, symbols);
+  }
+  munmap(image, st.st_size);
+  return symbols;
+}
+
+static bool lookup(const std::map<std::string, uint64_t>& symbols, const char* name, uint64_t* value)
+{
+  // Accept both the bare and the underscored label, like `nm | grep perf_start`
+  auto it = symbols.find(std::string("__") + name);
+  if (it == symbols.end())
+    it = symbols.find(name);
+  if (it == symbols.end())
+    return false;
+  *value = it->second;
+  return true;
+}
+
+static void close_regions_file()
+{
+  fclose(regions_file);
+}
+
+static void configure_regions()
+{
+  regions_configured = true;
+  s_vpi_vlog_info vinfo;
+  if (!vpi_get_vlog_info(&vinfo))
+    abort();
+  const char* fname = NULL;
+  const char* binary = NULL;
+  const char* testfile = NULL;
+  bool have_start = false, have_end = false;
+  for (int i = 1; i < vinfo.argc; i++) {
+    std::string arg(vinfo.argv[i]);
+    if (arg.find("+perf-regions=") == 0) {
+      fname = vinfo.argv[i] + strlen("+perf-regions=");
+    } else if (arg.find("+perf-start=") == 0) {
+      region_start_pc = strtoull(vinfo.argv[i] + strlen("+perf-start="), NULL, 16);
+      have_start = true;
+    } else if (arg.find("+perf-end=") == 0) {
+      region_end_pc = strtoull(vinfo.argv[i] + strlen("+perf-end="), NULL, 16);
+      have_end = true;
+    } else if (arg.find("+testfile=") == 0) {
+      testfile = vinfo.argv[i] + strlen("+testfile=");
+    } else if (!binary && arg[0] != '+' && arg[0] != '-') {
+      binary = vinfo.argv[i];
+    }
+  }
+  if (!fname)
+    return;
+
+  if (testfile)
+    binary = testfile;
+  if (!have_start || !have_end) {
+    std::map<std::string, uint64_t> symbols;
+    if (binary)
+      symbols = read_symbols(binary);
+    if ((!have_start && !lookup(symbols, "perf_start", &region_start_pc)) ||
+        (!have_end && !lookup(symbols, "perf_end", &region_end_pc))) {
+      fprintf(stderr, "PerfRegions: no perf_start/perf_end symbols in %s, not recording regions\n",
+              binary ? binary : "(no binary)");
+      return;
+    }
+  }
+
+  regions_file = fopen(fname, "w");
+  if (!regions_file) {
+    fprintf(stderr, "PerfRegions: unable to open %s\n", fname);
+    abort();
+  }
+  fprintf(regions_file, "hartid,region,start_cycle,end_cycle,cycles,instret,ipc\n");
+  atexit(close_regions_file);
+}
+
+extern "C" void perf_regions_init(long long int hartid,
+                                  unsigned char* enable,
+                                  long long int* start_pc,
+                                  long long int* end_pc)
+{
+  std::lock_guard<std::mutex> guard(regions_lock);
+  if (!regions_configured)
+    configure_regions();
+  *enable = regions_file != NULL;
+  *start_pc = region_start_pc;
+  *end_pc = region_end_pc;
+}
+
+extern "C" void perf_regions_mark(long long int hartid,
+                                  long long int cycle,
+                                  long long int instret,
+                                  unsigned char is_end)
+{
+  std::lock_guard<std::mutex> guard(regions_lock);
+  hart_region_t& r = hart_regions[hartid];
+  if (!is_end) {
+    // A nested or repeated start restarts the region
+    r.open = true;
+    r.start_cycle = cycle;
+    r.start_instret = instret;
+  } else if (r.open) {
+    uint64_t cycles = cycle - r.start_cycle;
+    uint64_t insns = instret - r.start_instret;
+    fprintf(regions_file, "%lld,%d,%lu,%lld,%lu,%lu,%.4f\n",
+            hartid, r.count, r.start_cycle, cycle, cycles, insns,
+            cycles ? (double)insns / cycles : 0.0);
+    r.open = false;
+    r.count++;
+  }
+}
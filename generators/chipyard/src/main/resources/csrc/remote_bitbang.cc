@@ -0,0 +1,275 @@
+// See LICENSE.Berkeley for license details.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "remote_bitbang.h"
+
+/////////// remote_bitbang_t
+
+remote_bitbang_t::remote_bitbang_t(uint16_t port) :
+  tck(0),
+  tms(0),
+  tdi(0),
+  trstn(1),
+  socket_fd(0),
+  client_fd(-1),
+  pending(0),
+  wait_writable(false),
+  quit(false),
+  err(0)
+{
+  socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (socket_fd == -1) {
+    fprintf(stderr, "remote_bitbang failed to make socket: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+
+  fcntl(socket_fd, F_SETFL, O_NONBLOCK);
+  int reuseaddr = 1;
+  if (setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &reuseaddr,
+                 sizeof(int)) == -1) {
+    fprintf(stderr, "remote_bitbang failed setsockopt: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+
+  if (bind(socket_fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+    fprintf(stderr, "remote_bitbang failed to bind socket: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+
+  if (listen(socket_fd, 1) == -1) {
+    fprintf(stderr, "remote_bitbang failed to listen on socket: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+
+  socklen_t addrlen = sizeof(addr);
+  if (getsockname(socket_fd, (struct sockaddr *) &addr, &addrlen) == -1) {
+    fprintf(stderr, "remote_bitbang getsockname failed: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+
+  epoll_fd = epoll_create1(0);
+  wake_fd = eventfd(0, EFD_NONBLOCK);
+  if (epoll_fd == -1 || wake_fd == -1) {
+    fprintf(stderr, "remote_bitbang failed to set up epoll: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = socket_fd;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket_fd, &ev);
+  ev.data.fd = wake_fd;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+  printf("Listening for remote bitbang connection on port %d.\n",
+         ntohs(addr.sin_port));
+  fflush(stdout);
+
+  service = std::thread(&remote_bitbang_t::service_main, this);
+}
+
+remote_bitbang_t::~remote_bitbang_t()
+{
+  uint64_t one = 1;
+  if (write(wake_fd, &one, sizeof(one)) == sizeof(one))
+    service.join();
+  else
+    service.detach();
+  close_client();
+  close(wake_fd);
+  close(epoll_fd);
+  close(socket_fd);
+}
+
+void remote_bitbang_t::service_main()
+{
+  struct epoll_event events[4];
+  while (true) {
+    int n = epoll_wait(epoll_fd, events, 4, -1);
+    if (n == -1) {
+      if (errno == EINTR)
+        continue;
+      fprintf(stderr, "remote_bitbang epoll_wait failed: %s (%d)\n", strerror(errno), errno);
+      abort();
+    }
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      if (fd == wake_fd)
+        return;
+      if (fd == socket_fd) {
+        accept_client();
+        continue;
+      }
+      if (events[i].events & EPOLLOUT) {
+        std::lock_guard<std::mutex> guard(lock);
+        flush_responses();
+      }
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        read_client();
+    }
+  }
+}
+
+void remote_bitbang_t::accept_client()
+{
+  int fd = accept(socket_fd, NULL, NULL);
+  if (fd == -1) {
+    if (errno == EAGAIN)
+      return;
+    fprintf(stderr, "remote_bitbang failed to accept on socket: %s (%d)\n", strerror(errno), errno);
+    abort();
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  if (client_fd != -1) {
+    // Only one debugger at a time
+    close(fd);
+    return;
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  client_fd = fd;
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+  fprintf(stderr, "Connected to remote bitbang client\n");
+}
+
+void remote_bitbang_t::read_client()
+{
+  char buf[4096];
+  std::lock_guard<std::mutex> guard(lock);
+  if (client_fd == -1)
+    return;
+  ssize_t num_read = read(client_fd, buf, sizeof(buf));
+  if (num_read > 0) {
+    commands.insert(commands.end(), buf, buf + num_read);
+    pending += num_read;
+  } else if (num_read == 0 || errno != EAGAIN) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, NULL);
+    close(client_fd);
+    client_fd = -1;
+    responses.clear();
+    wait_writable = false;
+  }
+}
+
+void remote_bitbang_t::close_client()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  if (client_fd != -1) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, NULL);
+    close(client_fd);
+    client_fd = -1;
+  }
+  responses.clear();
+  wait_writable = false;
+}
+
+// Write as many queued replies as the socket takes without blocking, and
+// have the service thread wait for writability if any are left. Called with
+// lock held.
+void remote_bitbang_t::flush_responses()
+{
+  if (client_fd == -1) {
+    responses.clear();
+    return;
+  }
+  while (!responses.empty()) {
+    char buf[4096];
+    size_t n = std::min(responses.size(), sizeof(buf));
+    std::copy(responses.begin(), responses.begin() + n, buf);
+    ssize_t written = write(client_fd, buf, n);
+    if (written == -1) {
+      if (errno == EAGAIN)
+        break;
+      fprintf(stderr, "remote_bitbang failed to write to socket: %s (%d)\n", strerror(errno), errno);
+      abort();
+    }
+    responses.erase(responses.begin(), responses.begin() + written);
+  }
+  if (wait_writable != !responses.empty()) {
+    wait_writable = !responses.empty();
+    struct epoll_event ev;
+    ev.events = wait_writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    ev.data.fd = client_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client_fd, &ev);
+  }
+}
+
+void remote_bitbang_t::tick(unsigned char * jtag_tck,
+                            unsigned char * jtag_tms,
+                            unsigned char * jtag_tdi,
+                            unsigned char * jtag_trstn,
+                            unsigned char jtag_tdo)
+{
+  // Only take the lock when the service thread has queued something
+  if (pending.load(std::memory_order_acquire)) {
+    char command;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      command = commands.front();
+      commands.pop_front();
+      pending--;
+    }
+    execute_command(command, jtag_tdo);
+  }
+
+  *jtag_tck = tck;
+  *jtag_tms = tms;
+  *jtag_tdi = tdi;
+  *jtag_trstn = trstn;
+}
+
+void remote_bitbang_t::execute_command(char command, unsigned char tdo)
+{
+  switch (command) {
+  case 'B': /* blink on */ break;
+  case 'b': /* blink off */ break;
+  // Reset commands carry (trst, srst); only trst reaches the JTAG pins
+  case 'r': trstn = 1; break;
+  case 's': trstn = 1; break;
+  case 't': trstn = 0; break;
+  case 'u': trstn = 0; break;
+  case '0': tck = 0; tms = 0; tdi = 0; break;
+  case '1': tck = 0; tms = 0; tdi = 1; break;
+  case '2': tck = 0; tms = 1; tdi = 0; break;
+  case '3': tck = 0; tms = 1; tdi = 1; break;
+  case '4': tck = 1; tms = 0; tdi = 0; break;
+  case '5': tck = 1; tms = 0; tdi = 1; break;
+  case '6': tck = 1; tms = 1; tdi = 0; break;
+  case '7': tck = 1; tms = 1; tdi = 1; break;
+  case 'R': {
+    char tosend = tdo ? '1' : '0';
+    std::lock_guard<std::mutex> guard(lock);
+    while (client_fd != -1 && write(client_fd, &tosend, sizeof(tosend)) == -1) {
+      if (errno != EAGAIN) {
+        fprintf(stderr, "remote_bitbang failed to write to socket: %s (%d)\n", strerror(errno), errno);
+        abort();
+      }
+    }
+    break;
+  }
+  case 'Q':
+    quit = true;
+    close_client();
+    break;
+  default:
+    fprintf(stderr, "remote_bitbang got unsupported command '%c'\n", command);
+  }
+}
@@ -0,0 +1,68 @@
+// See LICENSE.Berkeley for license details.
+
+#ifndef REMOTE_BITBANG_H
+#define REMOTE_BITBANG_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// OpenOCD remote_bitbang server for SimJTAG. Drop-in replacement for the
+// rocket-chip version: instead of polling the socket from every jtag_tick,
+// a service thread waits on epoll and queues incoming commands, so tick()
+// only pops from memory and never blocks on the debugger. Replies are queued
+// too, and whatever the socket does not take at once is sent by the service
+// thread when it becomes writable.
+class remote_bitbang_t
+{
+public:
+  // Create a new server, listening for connections from localhost on the
+  // given port (0 picks a free port).
+  remote_bitbang_t(uint16_t port);
+  ~remote_bitbang_t();
+
+  // Apply the next queued command, if any, to the JTAG pins.
+  void tick(unsigned char * jtag_tck,
+            unsigned char * jtag_tms,
+            unsigned char * jtag_tdi,
+            unsigned char * jtag_trstn,
+            unsigned char jtag_tdo);
+
+  bool done() { return quit; }
+  int exit_code() { return err; }
+
+private:
+  void service_main();
+  void accept_client();
+  void read_client();
+  void close_client();
+  void flush_responses();
+  void execute_command(char command, unsigned char tdo);
+
+  unsigned char tck;
+  unsigned char tms;
+  unsigned char tdi;
+  unsigned char trstn;
+
+  int socket_fd;
+  int client_fd;
+  int epoll_fd;
+  int wake_fd;
+  std::thread service;
+  std::mutex lock;
+  // Commands received from the client, not yet applied by tick()
+  std::deque<char> commands;
+  std::atomic<size_t> pending;
+  // Replies not yet written to the client
+  std::deque<char> responses;
+  // Whether epoll also waits for the client to become writable
+  bool wait_writable;
+
+  volatile bool quit;
+  int err;
+};
+
+#endif
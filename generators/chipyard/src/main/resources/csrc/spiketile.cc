@@ -2,11 +2,23 @@
 #include <riscv/processor.h>
 #include <riscv/log_file.h>
 #include <fesvr/context.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
 #include <sstream>
+#include <cmath>
+#include <cinttypes>
 #include <vpi_user.h>
 #include <svdpi.h>
 #include "testchip_tsi.h"
+#include "harness_profile.h"
 
 extern testchip_tsi_t* tsi;
 
@@ -38,6 +50,7 @@ struct stq_entry_t {
   uint64_t addr;
   uint64_t bytes;
   size_t len;
+  uint64_t pc;
 };
 
 struct cache_miss_t {
@@ -54,6 +67,119 @@ struct writeback_t {
   bool voluntary;
 };
 
+struct tcm_resp_t {
+  uint64_t cycle; // first cycle this beat may be returned
+  uint64_t sourceid;
+  uint32_t size;
+  bool has_data;
+  uint64_t data[8];
+};
+
+struct cache_stats_t {
+  uint64_t icache_hits;
+  uint64_t icache_misses;
+  uint64_t dcache_load_hits;
+  uint64_t dcache_store_hits;
+  uint64_t dcache_misses[3]; // indexed by transfer_t
+  uint64_t voluntary_wbs;
+  uint64_t probes;
+  uint64_t probe_wbs;
+  uint64_t stq_forwards;
+  uint64_t stq_stalls;
+  uint64_t mmio_accesses;
+  uint64_t mmio_readonly_hits;
+  uint64_t host_switches;
+  uint64_t skipped_switches;
+  uint64_t idle_cycles;
+};
+
+#if defined(__x86_64__) || defined(__aarch64__)
+#define SPIKE_FAST_CONTEXT 1
+#else
+#define SPIKE_FAST_CONTEXT 0
+#endif
+
+// Stackful coroutine used to interleave the Spike and store-queue threads
+// with the DPI host. fesvr's context_t goes through swapcontext, which makes
+// a sigprocmask syscall on every switch; on x86-64 and AArch64 we instead
+// save only the callee-saved registers and swap stacks by hand.
+//
+// resume() saves the caller in the coroutine itself and yield() returns to
+// it, so a tile may be resumed from whichever Verilator thread evaluates it
+// without any state shared between threads.
+class coroutine_t {
+public:
+  void init(void (*f)(void*), void* a);
+  void resume();
+  void yield();
+private:
+#if SPIKE_FAST_CONTEXT
+  void* sp;
+  void* caller_sp;
+#else
+  context_t* ctx;
+  context_t* caller;
+#endif
+};
+
+enum repl_policy_t {
+  REPL_RANDOM,
+  REPL_LRU,
+  REPL_PLRU
+};
+
+// Per-set replacement state for one cache. Each set owns a fixed slice of
+// the metadata array: a tree of n_ways-1 bits for PLRU, or one age byte per
+// way for LRU. The random policy uses a private xorshift generator so victim
+// selection never touches the global libc RNG.
+class cache_repl_t {
+public:
+  cache_repl_t(repl_policy_t policy, size_t n_sets, size_t n_ways, uint64_t seed);
+  void touch(size_t set, size_t way);
+  size_t victim(size_t set);
+private:
+  uint64_t next_random();
+
+  repl_policy_t policy;
+  size_t n_sets;
+  size_t n_ways;
+  size_t stride;
+  std::vector<uint8_t> meta;
+  uint64_t rng;
+};
+
+enum insn_class_t {
+  IC_INT,
+  IC_BRANCH,
+  IC_MUL,
+  IC_DIV,
+  IC_LOAD,
+  IC_STORE,
+  IC_AMO,
+  IC_FP,
+  IC_FDIV,
+  IC_VECTOR,
+  IC_SYSTEM,
+  IC_COUNT
+};
+
+// Approximate in-order timing. Every instruction class has an issue cost
+// (the reciprocal of its throughput) and a result latency, both held in
+// 1/256ths of a cycle. An instruction that reads the previous instruction's
+// destination also pays that instruction's remaining latency.
+class timing_model_t {
+public:
+  timing_model_t(const char* fname);
+  int64_t cost(insn_bits_t bits);
+  static const int64_t CYCLE = 256;
+private:
+  static insn_class_t classify(insn_bits_t bits);
+
+  int64_t issue[IC_COUNT];
+  int64_t stall[IC_COUNT];
+  uint32_t last_rd;
+  int64_t last_stall;
+};
 
 class chipyard_simif_t : public simif_t
 {
@@ -74,16 +200,22 @@ public:
 
   bool dcache_a(uint64_t *address, uint64_t* source, unsigned char* state_old, unsigned char* state_new);
   void dcache_b(uint64_t address, uint64_t source, int param);
-  bool dcache_c(uint64_t *address, uint64_t* source, int* param, unsigned char* voluntary, unsigned char* has_data, uint64_t* data[8]);
+  bool dcache_c(uint64_t *address, uint64_t* source, int* param, unsigned char* voluntary, unsigned char* has_data, uint64_t data[8]);
   void dcache_d(uint64_t sourceid, uint64_t data[8], unsigned char has_data, unsigned char grantack);
 
-  void tcm_a(uint64_t address, uint64_t data, uint32_t mask, uint32_t opcode, uint32_t size);
-  bool tcm_d(uint64_t *data);
+  void tcm_a(uint64_t address, uint64_t sourceid, const uint64_t data[8], uint64_t mask, uint32_t opcode, uint32_t size);
+  bool tcm_d(uint64_t *sourceid, int* size, unsigned char* has_data, uint64_t data[8]);
 
   void loadmem(const char* fname);
+  void set_replacement(repl_policy_t policy, uint64_t seed);
+  void yield_to_host();
+  void stall_on_host();
+  void resume(coroutine_t* c);
+  void dump_stats(FILE* f, int hartid);
 
   void drain_stq();
   bool stq_empty() { return st_q.size() == 0; };
+  bool quiescent();
 
   const cfg_t &get_cfg() const { return cfg; }
   const std::map<size_t, processor_t*>& get_harts() const { return harts; }
@@ -101,19 +233,35 @@ public:
                    size_t dcache_sourceids,
                    size_t tcm_base,
                    size_t tcm_size,
+                   size_t tcm_beat_bytes,
                    const char* isastr,
                    size_t pmpregions);
   uint64_t cycle;
   bool use_stq;
   htif_t *htif;
   bool fast_clint;
+  uint64_t tcm_latency;
   cfg_t cfg;
   std::map<size_t, processor_t*> harts;
+  cache_stats_t stats;
+  // Bumped on every change a stalled thread could be waiting on. The host
+  // only resumes a stalled thread once this has moved.
+  uint64_t epoch;
+  bool stalled;
+  // The Spike or store-queue coroutine the host last resumed
+  coroutine_t* running;
+  bool track_miss_pcs;
+  std::unordered_map<reg_t, uint64_t> miss_pcs;
 private:
+  void record_miss(reg_t pc);
+  reg_t insn_pc();
+  tcm_resp_t& tcm_push();
+
   bool handle_cache_access(reg_t addr, size_t len,
                            uint8_t* load_bytes,
                            const uint8_t* store_bytes,
-                           access_type type);
+                           access_type type,
+                           reg_t pc);
   void handle_mmio_access(reg_t addr, size_t len,
                           uint8_t* load_bytes,
                           const uint8_t* store_bytes,
@@ -132,6 +280,8 @@ private:
 
   std::vector<std::vector<cache_line_t>> dcache;
   std::vector<std::vector<cache_line_t>> icache;
+  cache_repl_t icache_repl;
+  cache_repl_t dcache_repl;
   std::vector<size_t> icache_sourceids;
   std::vector<size_t> dcache_a_sourceids;
   std::vector<size_t> dcache_c_sourceids;
@@ -157,7 +307,51 @@ private:
   uint64_t tcm_base;
   uint64_t tcm_size;
   uint8_t* tcm;
-  std::vector<uint64_t> tcm_q;
+  size_t tcm_beat_bytes;
+  size_t tcm_put_beats;
+  // Ring of pending D beats; the capacity is a power of two and doubles
+  // whenever a burst would overflow it
+  std::vector<tcm_resp_t> tcm_q;
+  size_t tcm_q_head;
+  size_t tcm_q_count;
+};
+
+enum sample_phase_t {
+  SAMPLE_SKIP,
+  SAMPLE_SETTLE,
+  SAMPLE_MEASURE
+};
+
+// Periodic measurement windows. The tile alternates between skipping ahead
+// with no per-cycle instruction limit, settling, and a measured window, the
+// last two in the normal mode. Skipped instructions still go through the
+// cache model and TileLink, as there is no host copy of memory to run them
+// against, so the cache stays warm and the speedup only comes from fewer
+// host switches. Settling lets the misses and stores a skip leaves in
+// flight drain before the window starts. Each window contributes one CPI
+// and miss-rate sample, computed from the cycle count and cache_stats_t
+// deltas.
+class sampler_t {
+public:
+  sampler_t(uint64_t skip, uint64_t settle, uint64_t window);
+  bool skipping() const { return phase == SAMPLE_SKIP; }
+  uint64_t budget(uint64_t ipc) const { return skipping() ? remaining : ipc; }
+  void advance(const cache_stats_t& stats, uint64_t cycle, uint64_t retired);
+  void report(FILE* f, int hartid);
+private:
+  void enter(sample_phase_t p, const cache_stats_t& stats, uint64_t cycle);
+
+  sample_phase_t phase;
+  uint64_t skip;
+  uint64_t settle;
+  uint64_t window;
+  uint64_t remaining;
+  uint64_t window_insns;
+  uint64_t window_cycle;
+  cache_stats_t window_stats;
+  std::vector<double> cpi;
+  std::vector<double> icache_miss_rate;
+  std::vector<double> dcache_miss_rate;
 };
 
 class tile_t {
@@ -166,121 +360,107 @@ public:
   processor_t* proc;
   chipyard_simif_t* simif;
   size_t max_insns;
-  context_t spike_context;
-  context_t stq_context;
+  coroutine_t spike_context;
+  coroutine_t stq_context;
+  bool spike_stalled;
+  uint64_t spike_epoch;
+  bool stq_stalled;
+  uint64_t stq_epoch;
+  // Set when the hart parked in WFI with nothing outstanding. The tile stays
+  // idle until an interrupt line, debug, or the simif epoch changes.
+  bool idle;
+  uint8_t idle_irqs;
+  uint64_t idle_epoch;
+  // Only set with +spike-timing. The Spike thread spends credit on each
+  // instruction and the host refills one cycle's worth every call.
+  timing_model_t* timing;
+  int64_t credit;
+  sampler_t* sampler;
+  // The stream the hart's processor_t logs through
+  std::unique_ptr<std::ostream> sout;
 };
 
-context_t *host;
 std::map<int, tile_t*> tiles;
-std::ostream sout(nullptr);
+// Guards tiles; init and reset may run on several Verilator threads
+static std::mutex tiles_lock;
+// Serializes stats dumps from tiles on different Verilator threads
+static std::mutex stats_lock;
 log_file_t* log_file;
+// Set once, before the first tile exists, so the per-cycle path on other
+// threads only ever reads them
+bool stats_enabled = false;
+uint64_t sample_skip = 0;
+uint64_t sample_settle = 0;
+uint64_t sample_window = 0;
+uint64_t stats_interval = 0;
+
+static void dump_all_stats()
+{
+  std::lock_guard<std::mutex> guard(stats_lock);
+  for (auto& t : tiles) {
+    if (stats_enabled)
+      t.second->simif->dump_stats(stdout, t.first);
+    if (t.second->sampler)
+      t.second->sampler->report(stdout, t.first);
+  }
+}
+
+// Plusargs shared by every tile
+static void parse_global_plusargs()
+{
+  s_vpi_vlog_info vinfo;
+  if (!vpi_get_vlog_info(&vinfo))
+    abort();
+  for (int i = 1; i < vinfo.argc; i++) {
+    std::string arg(vinfo.argv[i]);
+    if (arg == "+spike-stats" || arg == "+spike-stats-pcs") {
+      stats_enabled = true;
+    }
+    if (arg.find("+spike-stats=") == 0) {
+      stats_enabled = true;
+      stats_interval = strtoull(arg.c_str() + strlen("+spike-stats="), nullptr, 10);
+    }
+    if (arg.find("+spike-sample=") == 0) {
+      if (sscanf(arg.c_str(), "+spike-sample=%" SCNu64 ",%" SCNu64 ",%" SCNu64,
+                 &sample_skip, &sample_settle, &sample_window) != 3 || sample_window == 0) {
+        fprintf(stderr, "SpikeTile +spike-sample expects <skip>,<settle>,<window> instruction counts\n");
+        abort();
+      }
+    }
+  }
+  if (stats_enabled || sample_window) {
+    atexit(dump_all_stats);
+  }
+}
 
 extern "C" void spike_tile_reset(int hartid)
 {
+  std::lock_guard<std::mutex> guard(tiles_lock);
   if (tiles.find(hartid) != tiles.end()) {
     tiles[hartid]->proc->reset();
+    tiles[hartid]->idle = false;
   }
 }
 
-extern "C" void spike_tile(int hartid, char* isa,
-                           int pmpregions,
-                           int icache_sets, int icache_ways,
-                           int dcache_sets, int dcache_ways,
-                           char* cacheable, char* uncacheable, char* readonly_uncacheable, char* executable,
-                           int icache_sourceids, int dcache_sourceids,
-                           long long int tcm_base, long long int tcm_size,
-                           long long int reset_vector,
-                           long long int ipc,
-                           long long int cycle,
-                           long long int* insns_retired,
-
-                           char debug,
-                           char mtip, char msip, char meip,
-                           char seip,
-
-                           unsigned char icache_a_ready,
-                           unsigned char* icache_a_valid,
-                           long long int* icache_a_address,
-                           long long int* icache_a_sourceid,
-
-                           unsigned char icache_d_valid,
-                           long long int icache_d_sourceid,
-                           long long int icache_d_data_0,
-                           long long int icache_d_data_1,
-                           long long int icache_d_data_2,
-                           long long int icache_d_data_3,
-                           long long int icache_d_data_4,
-                           long long int icache_d_data_5,
-                           long long int icache_d_data_6,
-                           long long int icache_d_data_7,
-
-                           unsigned char dcache_a_ready,
-                           unsigned char* dcache_a_valid,
-                           long long int* dcache_a_address,
-                           long long int* dcache_a_sourceid,
-                           unsigned char* dcache_a_state_old,
-                           unsigned char* dcache_a_state_new,
-
-                           unsigned char dcache_b_valid,
-                           long long int dcache_b_address,
-                           long long int dcache_b_source,
-                           int dcache_b_param,
-
-                           unsigned char dcache_c_ready,
-                           unsigned char* dcache_c_valid,
-                           long long int* dcache_c_address,
-                           long long int* dcache_c_source,
-                           int* dcache_c_param,
-                           unsigned char* dcache_c_voluntary,
-                           unsigned char* dcache_c_has_data,
-                           long long int* dcache_c_data_0,
-                           long long int* dcache_c_data_1,
-                           long long int* dcache_c_data_2,
-                           long long int* dcache_c_data_3,
-                           long long int* dcache_c_data_4,
-                           long long int* dcache_c_data_5,
-                           long long int* dcache_c_data_6,
-                           long long int* dcache_c_data_7,
-
-                           unsigned char dcache_d_valid,
-                           unsigned char dcache_d_has_data,
-                           unsigned char dcache_d_grantack,
-                           long long int dcache_d_sourceid,
-                           long long int dcache_d_data_0,
-                           long long int dcache_d_data_1,
-                           long long int dcache_d_data_2,
-                           long long int dcache_d_data_3,
-                           long long int dcache_d_data_4,
-                           long long int dcache_d_data_5,
-                           long long int dcache_d_data_6,
-                           long long int dcache_d_data_7,
-
-                           unsigned char mmio_a_ready,
-                           unsigned char* mmio_a_valid,
-                           long long int* mmio_a_address,
-                           long long int* mmio_a_data,
-                           unsigned char* mmio_a_store,
-                           int* mmio_a_size,
-
-                           unsigned char mmio_d_valid,
-                           long long int mmio_d_data,
-
-                           unsigned char tcm_a_valid,
-                           long long int tcm_a_address,
-                           long long int tcm_a_data,
-                           int tcm_a_mask,
-                           int tcm_a_opcode,
-                           int tcm_a_size,
-
-                           unsigned char* tcm_d_valid,
-                           unsigned char tcm_d_ready,
-                           long long int* tcm_d_data
-                           )
+// The SpikeBlackBox calls spike_tile_init once, on its first cycle out of
+// reset, and keeps the returned tile as a chandle. The per-cycle spike_tile
+// call only carries what changes every cycle, and each TileLink channel has
+// its own entry point which the Verilog only calls when the channel fires,
+// so idle channels cost nothing to marshal.
+extern "C" void* spike_tile_init(int hartid, char* isa,
+                                 int pmpregions,
+                                 int icache_sets, int icache_ways,
+                                 int dcache_sets, int dcache_ways,
+                                 char* cacheable, char* uncacheable, char* readonly_uncacheable, char* executable,
+                                 int icache_sourceids, int dcache_sourceids,
+                                 long long int tcm_base, long long int tcm_size,
+                                 int tcm_beat_bytes,
+                                 long long int reset_vector)
 {
-  if (!host) {
-    host = context_t::current();
-    sout.rdbuf(std::cerr.rdbuf());
+  std::lock_guard<std::mutex> guard(tiles_lock);
+  if (!log_file) {
     log_file = new log_file_t(nullptr);
+    parse_global_plusargs();
   }
   if (tiles.find(hartid) == tiles.end()) {
     printf("Constructing spike processor_t\n");
@@ -290,21 +470,27 @@ extern "C" void spike_tile(int hartid, char* isa,
                                                    dcache_ways, dcache_sets,
                                                    cacheable, uncacheable, readonly_uncacheable, executable,
                                                    icache_sourceids, dcache_sourceids,
-                                                   tcm_base, tcm_size,
+                                                   tcm_base, tcm_size, tcm_beat_bytes,
                                                    isastr->c_str(), pmpregions);
+    // Each hart logs through its own stream over cerr's stdio-synced
+    // buffer, so harts on different threads share no stream state
+    std::unique_ptr<std::ostream> sout(new std::ostream(std::cerr.rdbuf()));
     processor_t* p = new processor_t(isa_parser,
                                      &simif->get_cfg(),
                                      simif,
                                      hartid,
                                      false,
                                      log_file->get(),
-                                     sout);
+                                     *sout);
     simif->harts[hartid] = p;
 
     s_vpi_vlog_info vinfo;
     if (!vpi_get_vlog_info(&vinfo))
       abort();
     std::string loadmem_file = "";
+    std::string timing_file = "";
+    repl_policy_t repl_policy = REPL_RANDOM;
+    uint64_t seed = 0;
     for (int i = 1; i < vinfo.argc; i++) {
       std::string arg(vinfo.argv[i]);
       if (arg == "+spike-debug") {
@@ -319,19 +505,63 @@ extern "C" void spike_tile(int hartid, char* isa,
       if (arg == "+spike-fast-clint") {
         simif->fast_clint = true;
       }
+      if (arg.find("+spike-tcm-latency=") == 0) {
+        simif->tcm_latency = strtoull(arg.c_str() + strlen("+spike-tcm-latency="), nullptr, 10);
+      }
+      if (arg.find("+spike-timing=") == 0) {
+        timing_file = arg.substr(strlen("+spike-timing="));
+      }
       if (arg == "+spike-verbose") {
         p->enable_log_commits();
       }
+      if (arg.find("+spike-repl=") == 0) {
+        std::string policy = arg.substr(strlen("+spike-repl="));
+        if (policy == "random") {
+          repl_policy = REPL_RANDOM;
+        } else if (policy == "lru") {
+          repl_policy = REPL_LRU;
+        } else if (policy == "plru") {
+          repl_policy = REPL_PLRU;
+        } else {
+          fprintf(stderr, "SpikeTile unknown replacement policy %s\n", policy.c_str());
+          abort();
+        }
+      }
+      if (arg.find("+seed=") == 0) {
+        seed = strtoull(arg.c_str() + strlen("+seed="), nullptr, 10);
+      }
+      if (arg == "+spike-stats-pcs") {
+        simif->track_miss_pcs = true;
+      }
     }
+    // Mix in the hartid so every tile draws an independent, reproducible stream
+    simif->set_replacement(repl_policy, seed ^ ((uint64_t)hartid << 32));
     if (loadmem_file != "" && tcm_size > 0)
       simif->loadmem(loadmem_file.c_str());
 
     p->reset();
     p->get_state()->pc = reset_vector;
     tiles[hartid] = new tile_t(p, simif);
+    tiles[hartid]->sout = std::move(sout);
+    if (timing_file != "")
+      tiles[hartid]->timing = new timing_model_t(timing_file.c_str());
+    if (sample_window)
+      tiles[hartid]->sampler = new sampler_t(sample_skip, sample_settle, sample_window);
     printf("Done constructing spike processor\n");
   }
-  tile_t* tile = tiles[hartid];
+  return tiles[hartid];
+}
+
+extern "C" void spike_tile(void* handle,
+                           long long int ipc,
+                           long long int cycle,
+                           long long int* insns_retired,
+                           char debug,
+                           char mtip, char msip, char meip,
+                           char seip)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  tile_t* tile = (tile_t*)handle;
   chipyard_simif_t* simif = tile->simif;
   processor_t* proc = tile->proc;
   if (!simif->htif && tsi) {
@@ -339,6 +569,19 @@ extern "C" void spike_tile(int hartid, char* isa,
   }
 
   simif->cycle = cycle;
+  if (stats_interval && cycle % stats_interval == 0) {
+    std::lock_guard<std::mutex> guard(stats_lock);
+    simif->dump_stats(stdout, simif->harts.begin()->first);
+  }
+
+  uint8_t irqs = (mtip ? 1 : 0) | (msip ? 2 : 0) | (meip ? 4 : 0) | (seip ? 8 : 0);
+  if (tile->idle && !debug && irqs == tile->idle_irqs && simif->epoch == tile->idle_epoch) {
+    simif->stats.idle_cycles++;
+    *insns_retired = 0;
+    return;
+  }
+  tile->idle = false;
+
   if (debug) {
     proc->halt_request = proc->HR_REGULAR;
   }
@@ -348,65 +591,124 @@ extern "C" void spike_tile(int hartid, char* isa,
   proc->get_state()->mip->backdoor_write_with_mask(MIP_MEIP, meip ? MIP_MEIP : 0);
   proc->get_state()->mip->backdoor_write_with_mask(MIP_SEIP, seip ? MIP_SEIP : 0);
 
-  tile->max_insns = ipc;
+  tile->max_insns = tile->sampler ? tile->sampler->budget(ipc) : ipc;
+  if (tile->timing) {
+    tile->credit += timing_model_t::CYCLE;
+    if (tile->credit > timing_model_t::CYCLE)
+      tile->credit = timing_model_t::CYCLE;
+  }
   uint64_t pre_insns = proc->get_state()->minstret->read();
-  tile->spike_context.switch_to();
+  // A thread stalled on a miss or MMIO would just retry and yield again, so
+  // leave it suspended until some channel has made progress
+  if (!tile->spike_stalled || tile->spike_epoch != simif->epoch) {
+    simif->stalled = false;
+    simif->resume(&tile->spike_context);
+    tile->spike_stalled = simif->stalled;
+    tile->spike_epoch = simif->epoch;
+  } else {
+    simif->stats.skipped_switches++;
+  }
   *insns_retired = proc->get_state()->minstret->read() - pre_insns;
-  if (simif->use_stq) {
-    tile->stq_context.switch_to();
+  if (tile->sampler) {
+    tile->sampler->advance(simif->stats, cycle, *insns_retired);
   }
-
-  *icache_a_valid = 0;
-  if (icache_a_ready) {
-    *icache_a_valid = simif->icache_a((uint64_t*)icache_a_address,
-                                      (uint64_t*)icache_a_sourceid);
+  if (simif->use_stq && (!tile->stq_stalled || tile->stq_epoch != simif->epoch)) {
+    simif->stalled = false;
+    simif->resume(&tile->stq_context);
+    tile->stq_stalled = simif->stalled;
+    tile->stq_epoch = simif->epoch;
   }
 
-  if (icache_d_valid) {
-    uint64_t data[8] = {icache_d_data_0, icache_d_data_1, icache_d_data_2, icache_d_data_3,
-                        icache_d_data_4, icache_d_data_5, icache_d_data_6, icache_d_data_7};
-    simif->icache_d(icache_d_sourceid, data);
+  if (proc->is_waiting_for_interrupt() && !simif->fast_clint && simif->quiescent()) {
+    tile->idle = true;
+    tile->idle_irqs = irqs;
+    tile->idle_epoch = simif->epoch;
   }
+}
 
-  *dcache_a_valid = 0;
-  if (dcache_a_ready) {
-    *dcache_a_valid = simif->dcache_a((uint64_t*)dcache_a_address,
-                                      (uint64_t*)dcache_a_sourceid,
-                                      dcache_a_state_old, dcache_a_state_new);
-  }
-  if (dcache_b_valid) {
-    simif->dcache_b(dcache_b_address, dcache_b_source, dcache_b_param);
-  }
-  *dcache_c_valid = 0;
-  if (dcache_c_ready) {
-    uint64_t* data[8] = {(uint64_t*)dcache_c_data_0, (uint64_t*)dcache_c_data_1, (uint64_t*)dcache_c_data_2, (uint64_t*)dcache_c_data_3,
-                         (uint64_t*)dcache_c_data_4, (uint64_t*)dcache_c_data_5, (uint64_t*)dcache_c_data_6, (uint64_t*)dcache_c_data_7};
-    *dcache_c_valid = simif->dcache_c((uint64_t*)dcache_c_address, (uint64_t*)dcache_c_source, (int*)dcache_c_param,
-                                      dcache_c_voluntary, dcache_c_has_data, data);
-  }
-  if (dcache_d_valid) {
-    uint64_t data[8] = {dcache_d_data_0, dcache_d_data_1, dcache_d_data_2, dcache_d_data_3,
-                        dcache_d_data_4, dcache_d_data_5, dcache_d_data_6, dcache_d_data_7};
-    simif->dcache_d(dcache_d_sourceid, data, dcache_d_has_data, dcache_d_grantack);
-  }
+extern "C" unsigned char spike_tile_icache_a(void* handle, long long int* address, long long int* sourceid)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  return ((tile_t*)handle)->simif->icache_a((uint64_t*)address, (uint64_t*)sourceid);
+}
 
-  *mmio_a_valid = 0;
-  if (mmio_a_ready) {
-    *mmio_a_valid = simif->mmio_a((uint64_t*)mmio_a_address, (uint64_t*) mmio_a_data,
-                                  mmio_a_store, mmio_a_size);
-  }
-  if (mmio_d_valid) {
-    simif->mmio_d(mmio_d_data);
-  }
+extern "C" void spike_tile_icache_d(void* handle, long long int sourceid, const svBitVecVal* data)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  uint64_t beat[8];
+  memcpy(beat, data, sizeof(beat));
+  ((tile_t*)handle)->simif->icache_d(sourceid, beat);
+}
 
-  if (tcm_a_valid) {
-    simif->tcm_a(tcm_a_address, tcm_a_data, tcm_a_mask, tcm_a_opcode, tcm_a_size);
-  }
-  if (tcm_d_ready) {
-    *tcm_d_valid = simif->tcm_d((uint64_t*)tcm_d_data);
-  }
+extern "C" unsigned char spike_tile_dcache_a(void* handle, long long int* address, long long int* sourceid,
+                                             unsigned char* state_old, unsigned char* state_new)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  return ((tile_t*)handle)->simif->dcache_a((uint64_t*)address, (uint64_t*)sourceid, state_old, state_new);
+}
+
+extern "C" void spike_tile_dcache_b(void* handle, long long int address, long long int source, int param)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  ((tile_t*)handle)->simif->dcache_b(address, source, param);
+}
+
+extern "C" unsigned char spike_tile_dcache_c(void* handle, long long int* address, long long int* sourceid,
+                                             int* param, unsigned char* voluntary, unsigned char* has_data,
+                                             svBitVecVal* data)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  uint64_t beat[8];
+  if (!((tile_t*)handle)->simif->dcache_c((uint64_t*)address, (uint64_t*)sourceid, param,
+                                          voluntary, has_data, beat)) {
+    return 0;
+  }
+  memcpy(data, beat, sizeof(beat));
+  return 1;
+}
+
+extern "C" void spike_tile_dcache_d(void* handle, long long int sourceid, unsigned char has_data,
+                                    unsigned char grantack, const svBitVecVal* data)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  uint64_t beat[8];
+  memcpy(beat, data, sizeof(beat));
+  ((tile_t*)handle)->simif->dcache_d(sourceid, beat, has_data, grantack);
+}
+
+extern "C" unsigned char spike_tile_mmio_a(void* handle, long long int* address, long long int* data,
+                                           unsigned char* store, int* size)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  return ((tile_t*)handle)->simif->mmio_a((uint64_t*)address, (uint64_t*)data, store, size);
 }
 
+extern "C" void spike_tile_mmio_d(void* handle, long long int data)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  ((tile_t*)handle)->simif->mmio_d(data);
+}
+
+extern "C" void spike_tile_tcm_a(void* handle, long long int address, long long int sourceid,
+                                 const svBitVecVal* data, long long int mask, int opcode, int size)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  uint64_t beat[8];
+  memcpy(beat, data, sizeof(beat));
+  ((tile_t*)handle)->simif->tcm_a(address, sourceid, beat, mask, opcode, size);
+}
+
+extern "C" unsigned char spike_tile_tcm_d(void* handle, long long int* sourceid, int* size,
+                                          unsigned char* has_data, svBitVecVal* data)
+{
+  harness_profile_scope_t prof(PROFILE_SPIKETILE);
+  uint64_t beat[8];
+  if (!((tile_t*)handle)->simif->tcm_d((uint64_t*)sourceid, size, has_data, beat)) {
+    return 0;
+  }
+  memcpy(data, beat, sizeof(beat));
+  return 1;
+}
 
 chipyard_simif_t::chipyard_simif_t(size_t icache_ways,
                                    size_t icache_sets,
@@ -420,6 +722,7 @@ chipyard_simif_t::chipyard_simif_t(size_t icache_ways,
                                    size_t dc_sourceids,
                                    size_t tcm_base,
                                    size_t tcm_size,
+                                   size_t tcm_beat_bytes,
                                    const char* isastr,
                                    size_t pmpregions
                                    ) :
@@ -427,6 +730,7 @@ chipyard_simif_t::chipyard_simif_t(size_t icache_ways,
   use_stq(false),
   htif(nullptr),
   fast_clint(false),
+  tcm_latency(0),
   cfg(std::make_pair(0, 0),
       nullptr,
       isastr,
@@ -439,14 +743,26 @@ chipyard_simif_t::chipyard_simif_t(size_t icache_ways,
       std::vector<size_t>(),
       false,
       0),
+  stats(),
+  epoch(0),
+  stalled(false),
+  running(nullptr),
+  track_miss_pcs(false),
   icache_ways(icache_ways),
   icache_sets(icache_sets),
   dcache_ways(dcache_ways),
   dcache_sets(dcache_sets),
+  icache_repl(REPL_RANDOM, icache_sets, icache_ways, 0),
+  dcache_repl(REPL_RANDOM, dcache_sets, dcache_ways, 1),
+  mmio_valid(false),
+  mmio_inflight(false),
   tcm_base(tcm_base),
   tcm_size(tcm_size),
-  mmio_valid(false),
-  mmio_inflight(false)
+  tcm_beat_bytes(tcm_beat_bytes),
+  tcm_put_beats(0),
+  tcm_q(16),
+  tcm_q_head(0),
+  tcm_q_count(0)
 {
 
   icache.resize(icache_ways);
@@ -501,6 +817,11 @@ chipyard_simif_t::chipyard_simif_t(size_t icache_ways,
     executables.push_back(mem_region_t { base_int, size_int });
   }
 
+  if (tcm_size > 0 && (tcm_beat_bytes < 8 || tcm_beat_bytes > 64 ||
+                       (tcm_beat_bytes & (tcm_beat_bytes - 1)) != 0)) {
+    fprintf(stderr, "SpikeTile TCM beat size %ld must be a power of two between 8 and 64 bytes\n", tcm_beat_bytes);
+    abort();
+  }
   tcm = (uint8_t*)malloc(tcm_size);
 }
 
@@ -534,8 +855,8 @@ bool chipyard_simif_t::mmio_fetch(reg_t addr, size_t len, uint8_t* bytes) {
     return false;
   }
 
-  while (!handle_cache_access(addr, len, bytes, nullptr, FETCH)) {
-    host->switch_to();
+  while (!handle_cache_access(addr, len, bytes, nullptr, FETCH, addr)) {
+    stall_on_host();
   }
   return true;
 }
@@ -576,8 +897,9 @@ bool chipyard_simif_t::mmio_load(reg_t addr, size_t len, uint8_t* bytes) {
   }
 
   if (cacheable) {
-    while (!handle_cache_access(addr, len, bytes, nullptr, LOAD)) {
-      host->switch_to();
+    reg_t pc = insn_pc();
+    while (!handle_cache_access(addr, len, bytes, nullptr, LOAD, pc)) {
+      stall_on_host();
     }
   } else {
     handle_mmio_access(addr, len, bytes, nullptr, LOAD, readonly);
@@ -594,11 +916,13 @@ void chipyard_simif_t::handle_mmio_access(reg_t addr, size_t len,
   if (type == LOAD && readonly) {
     auto it = readonly_cache.find(std::make_pair(addr, len));
     if (it != readonly_cache.end()) {
+      stats.mmio_readonly_hits++;
       memcpy(load_bytes, &(it->second), len);
       return;
     }
   }
 
+  stats.mmio_accesses++;
   mmio_valid = true;
   mmio_inflight = false;
   mmio_addr = addr;
@@ -610,7 +934,7 @@ void chipyard_simif_t::handle_mmio_access(reg_t addr, size_t len,
   mmio_len = len;
 
   while (mmio_valid) {
-    host->switch_to();
+    stall_on_host();
   }
   if (type == LOAD) {
     memcpy(load_bytes , &mmio_lddata, len);
@@ -623,7 +947,8 @@ void chipyard_simif_t::handle_mmio_access(reg_t addr, size_t len,
 bool chipyard_simif_t::handle_cache_access(reg_t addr, size_t len,
                                            uint8_t* load_bytes,
                                            const uint8_t* store_bytes,
-                                           access_type type) {
+                                           access_type type,
+                                           reg_t pc) {
   uint64_t stdata = 0;
   if (type == STORE) {
     assert(len <= 8);
@@ -647,13 +972,16 @@ bool chipyard_simif_t::handle_cache_access(reg_t addr, size_t len,
     for (auto& s : st_q) {
       if (addr == s.addr && len < s.len) {
         // Forwarding
+        stats.stq_forwards++;
         memcpy(load_bytes, &(s.bytes), len);
         return true;
       }
       if (addr < s.addr && addr + len > s.addr) {
+        stats.stq_stalls++;
         return false;
       }
       if (s.addr < addr && s.addr + s.len > addr) {
+        stats.stq_stalls++;
         return false;
       }
     }
@@ -673,8 +1001,15 @@ bool chipyard_simif_t::handle_cache_access(reg_t addr, size_t len,
     }
   }
 
+  cache_repl_t *repl = type == FETCH ? &icache_repl : &dcache_repl;
   if (type != STORE) {
     if (cache_hit) {
+      repl->touch(setidx, hit_way);
+      if (type == FETCH) {
+        stats.icache_hits++;
+      } else {
+        stats.dcache_load_hits++;
+      }
       memcpy(load_bytes, (uint8_t*)((*cache)[hit_way][setidx].data) + offset, len);
       return true;
     }
@@ -685,6 +1020,9 @@ bool chipyard_simif_t::handle_cache_access(reg_t addr, size_t len,
       }
     }
     if (cache_hit && dcache[hit_way][setidx].state != BRANCH) {
+      repl->touch(setidx, hit_way);
+      stats.dcache_store_hits++;
+      epoch++;
       dcache[hit_way][setidx].state = DIRTY;
       memcpy((uint8_t*)(dcache[hit_way][setidx].data) + offset, store_bytes, len);
       return true;
@@ -711,23 +1049,18 @@ bool chipyard_simif_t::handle_cache_access(reg_t addr, size_t len,
   }
 
 
-  size_t repl_way = rand() % n_ways;
   transfer_t upgrade;
-  size_t upgrade_way;
   bool do_repl;
   if (type == STORE) {
     if (cache_hit && (*cache)[hit_way][setidx].state != NONE) {
       upgrade = BToT;
-      upgrade_way = hit_way;
       do_repl = false;
     } else {
       upgrade = NToT;
-      upgrade_way = repl_way;
       do_repl = true;
     }
   } else {
     upgrade = NToB;
-    upgrade_way = repl_way;
     do_repl = true;
   }
   if (do_repl) {
@@ -743,11 +1076,24 @@ bool chipyard_simif_t::handle_cache_access(reg_t addr, size_t len,
     }
   }
 
+  // Only consult the replacement policy once the miss is actually issued, so
+  // retried accesses don't advance the random stream
+  size_t repl_way = do_repl ? repl->victim(setidx) : hit_way;
+  size_t upgrade_way = do_repl ? repl_way : hit_way;
+
   missq->push_back(cache_miss_t { true, addr, upgrade_way, upgrade });
+  epoch++;
+  record_miss(pc);
+  if (type == FETCH) {
+    stats.icache_misses++;
+  } else {
+    stats.dcache_misses[upgrade]++;
+  }
 
   cache_line_t repl_cl = (*cache)[repl_way][setidx];
   if (do_repl) {
     if (repl_cl.state == DIRTY) {
+      stats.voluntary_wbs++;
       wb_q.push_back(writeback_t { repl_cl, NONE, 0, true});
     }
     (*cache)[repl_way][setidx].state = NONE;
@@ -768,6 +1114,7 @@ bool chipyard_simif_t::icache_a(uint64_t* address, uint64_t* sourceid) {
 
   icache_sourceids.erase(icache_sourceids.begin());
   icache_miss_q.erase(icache_miss_q.begin());
+  epoch++;
 
   return true;
 }
@@ -778,8 +1125,10 @@ void chipyard_simif_t::icache_d(uint64_t sourceid, uint64_t data[8]) {
   icache_inflight[sourceid].valid = false;
   icache[miss.way][setidx].state = BRANCH;
   icache[miss.way][setidx].addr = miss.addr;
+  icache_repl.touch(setidx, miss.way);
   memcpy(icache[miss.way][setidx].data, (void*)data, 64);
   icache_sourceids.push_back(sourceid);
+  epoch++;
 }
 
 bool chipyard_simif_t::mmio_a(uint64_t* address, uint64_t* data, unsigned char* store, int* size) {
@@ -787,6 +1136,7 @@ bool chipyard_simif_t::mmio_a(uint64_t* address, uint64_t* data, unsigned char*
     return false;
   }
   mmio_inflight = true;
+  epoch++;
   *address = mmio_addr;
   *store = mmio_st;
   *data = mmio_stdata;
@@ -799,6 +1149,7 @@ void chipyard_simif_t::mmio_d(uint64_t data) {
   mmio_inflight = false;
   size_t offset = mmio_addr & 7;
   mmio_lddata = data >> (offset * 8);
+  epoch++;
 }
 
 bool chipyard_simif_t::dcache_a(uint64_t *address, uint64_t* source, unsigned char* state_old, unsigned char* state_new) {
@@ -825,6 +1176,7 @@ bool chipyard_simif_t::dcache_a(uint64_t *address, uint64_t* source, unsigned ch
   dcache_inflight[dcache_a_sourceids[0]] = dcache_miss_q[0];
   dcache_a_sourceids.erase(dcache_a_sourceids.begin());
   dcache_miss_q.erase(dcache_miss_q.begin());
+  epoch++;
   return true;
 }
 
@@ -852,6 +1204,11 @@ void chipyard_simif_t::dcache_b(uint64_t address, uint64_t source, int param) {
     desired = NONE;
     break;
   }
+  stats.probes++;
+  epoch++;
+  if (cache_hit && dcache[hit_way][setidx].state == DIRTY) {
+    stats.probe_wbs++;
+  }
   if (!cache_hit) {
     cache_line_t miss { NONE, address, {} };
     wb_q.push_back(writeback_t { miss, desired, source, false});
@@ -868,7 +1225,7 @@ void chipyard_simif_t::dcache_b(uint64_t address, uint64_t source, int param) {
 
 bool chipyard_simif_t::dcache_c(uint64_t* address, uint64_t* source, int* param, unsigned char* voluntary,
                                 unsigned char* has_data,
-                                uint64_t* data[8]) {
+                                uint64_t data[8]) {
   if (wb_q.empty())
     return false;
 
@@ -903,10 +1260,9 @@ bool chipyard_simif_t::dcache_c(uint64_t* address, uint64_t* source, int* param,
   SHRINK(NONE   , BRANCH , false, 2);
   SHRINK(NONE   , NONE   , false, 5);
 
-  for (int i = 0; i < 8; i++) {
-    *(data[i]) = wb.line.data[i];
-  }
+  memcpy(data, wb.line.data, 64);
   wb_q.erase(wb_q.begin());
+  epoch++;
   return true;
 }
 
@@ -940,10 +1296,12 @@ bool chipyard_simif_t::mmio_store(reg_t addr, size_t len, const uint8_t* bytes)
       assert(len <= 8);
       uint64_t stdata;
       memcpy(&stdata, bytes, len);
-      st_q.push_back(stq_entry_t { addr, stdata, len });
+      st_q.push_back(stq_entry_t { addr, stdata, len, insn_pc() });
+      epoch++;
     } else {
-      while (!handle_cache_access(addr, len, nullptr, bytes, STORE)) {
-        host->switch_to();
+      reg_t pc = insn_pc();
+      while (!handle_cache_access(addr, len, nullptr, bytes, STORE, pc)) {
+        stall_on_host();
       }
     }
   } else {
@@ -956,13 +1314,14 @@ bool chipyard_simif_t::mmio_store(reg_t addr, size_t len, const uint8_t* bytes)
 void chipyard_simif_t::drain_stq() {
   while (true) {
     while (st_q.size() == 0) {
-      host->switch_to();
+      stall_on_host();
     }
     stq_entry_t store = st_q[0];
-    while (!handle_cache_access(store.addr, store.len, nullptr, (uint8_t*)(&(store.bytes)), STORE)) {
-      host->switch_to();
+    while (!handle_cache_access(store.addr, store.len, nullptr, (uint8_t*)(&(store.bytes)), STORE, store.pc)) {
+      stall_on_host();
     }
     st_q.erase(st_q.begin());
+    epoch++;
   }
 }
 
@@ -980,43 +1339,509 @@ void chipyard_simif_t::dcache_d(uint64_t sourceid, uint64_t data[8], unsigned ch
       dcache[miss.way][setidx].state = TRUNK;
     }
     dcache[miss.way][setidx].addr = miss.addr;
+    dcache_repl.touch(setidx, miss.way);
     dcache_a_sourceids.push_back(sourceid);
   } else {
     dcache_c_sourceids.push_back(sourceid);
   }
+  epoch++;
+}
+
+// Spread the 8 bits of a byte mask into 8 full byte lanes
+static inline uint64_t expand_byte_mask(uint8_t m) {
+  uint64_t x = (m * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+  return (((x + 0x7f7f7f7f7f7f7f7fULL) & 0x8080808080808080ULL) >> 7) * 0xff;
+}
+
+tcm_resp_t& chipyard_simif_t::tcm_push() {
+  if (tcm_q_count == tcm_q.size()) {
+    std::vector<tcm_resp_t> grown(tcm_q.size() * 2);
+    for (size_t i = 0; i < tcm_q_count; i++) {
+      grown[i] = tcm_q[(tcm_q_head + i) & (tcm_q.size() - 1)];
+    }
+    tcm_q.swap(grown);
+    tcm_q_head = 0;
+  }
+  tcm_resp_t& resp = tcm_q[(tcm_q_head + tcm_q_count) & (tcm_q.size() - 1)];
+  tcm_q_count++;
+  return resp;
 }
 
-void chipyard_simif_t::tcm_a(uint64_t address, uint64_t data, uint32_t mask, uint32_t opcode, uint32_t size) {
+// A-channel beats arrive at the TCM port width. Bursts keep the base address
+// on every beat, so Puts count beats and only acknowledge the last one, while
+// a Get queues every response beat up front. The D channel drains at most one
+// beat per cycle, tcm_latency cycles after the request.
+void chipyard_simif_t::tcm_a(uint64_t address, uint64_t sourceid, const uint64_t data[8], uint64_t mask, uint32_t opcode, uint32_t size) {
   bool load = opcode == 4;
-  uint64_t rdata = 0;
-  memcpy(&rdata, tcm + address - tcm_base, 8);
-  tcm_q.push_back(rdata);
-
-  if (!load) {
-    for (size_t i = 0; i < 8; i++) {
-      if ((mask >> i) & 1) {
-        memcpy(tcm + address - tcm_base + i, ((uint8_t*)&data) + i, 1);
-      }
+  size_t bytes = (size_t)1 << size;
+  size_t beats = bytes > tcm_beat_bytes ? bytes / tcm_beat_bytes : 1;
+  uint64_t offset = (address - tcm_base) & ~(uint64_t)(tcm_beat_bytes - 1);
+
+  if (load) {
+    for (size_t i = 0; i < beats; i++) {
+      tcm_resp_t& resp = tcm_push();
+      resp.cycle = cycle + tcm_latency;
+      resp.sourceid = sourceid;
+      resp.size = size;
+      resp.has_data = true;
+      memcpy(resp.data, tcm + offset + i * tcm_beat_bytes, tcm_beat_bytes);
     }
+    return;
+  }
+
+  uint8_t* dst = tcm + offset + tcm_put_beats * tcm_beat_bytes;
+  for (size_t w = 0; w < tcm_beat_bytes / 8; w++) {
+    uint8_t m = mask >> (w * 8);
+    if (m == 0xff) {
+      memcpy(dst + w * 8, &data[w], 8);
+    } else if (m) {
+      uint64_t lanes = expand_byte_mask(m);
+      uint64_t old;
+      memcpy(&old, dst + w * 8, 8);
+      old = (old & ~lanes) | (data[w] & lanes);
+      memcpy(dst + w * 8, &old, 8);
+    }
+  }
+  if (++tcm_put_beats < beats) {
+    return;
   }
+  tcm_put_beats = 0;
+  tcm_resp_t& resp = tcm_push();
+  resp.cycle = cycle + tcm_latency;
+  resp.sourceid = sourceid;
+  resp.size = size;
+  resp.has_data = false;
 }
 
-bool chipyard_simif_t::tcm_d(uint64_t* data) {
-  if (tcm_q.size() == 0)
+bool chipyard_simif_t::tcm_d(uint64_t* sourceid, int* size, unsigned char* has_data, uint64_t data[8]) {
+  if (tcm_q_count == 0)
     return false;
-  *data = tcm_q[0];
-  tcm_q.erase(tcm_q.begin());
+  tcm_resp_t& resp = tcm_q[tcm_q_head];
+  if (resp.cycle > cycle)
+    return false;
+  *sourceid = resp.sourceid;
+  *size = resp.size;
+  *has_data = resp.has_data;
+  memcpy(data, resp.data, sizeof(resp.data));
+  tcm_q_head = (tcm_q_head + 1) & (tcm_q.size() - 1);
+  tcm_q_count--;
   return true;
 }
 
-#define parse_nibble(c) ((c) >= 'a' ? (c)-'a'+10 : (c)-'0')
-void chipyard_simif_t::loadmem(const char* fname) {
+void chipyard_simif_t::resume(coroutine_t* c) {
+  running = c;
+  c->resume();
+}
+
+void chipyard_simif_t::yield_to_host() {
+  stats.host_switches++;
+  running->yield();
+}
+
+void chipyard_simif_t::stall_on_host() {
+  stalled = true;
+  yield_to_host();
+}
+
+// Spike only advances state.pc once an instruction completes, so inside
+// mmio_load/mmio_store this is the PC of the load or store itself
+reg_t chipyard_simif_t::insn_pc() {
+  return harts.begin()->second->get_state()->pc;
+}
+
+void chipyard_simif_t::record_miss(reg_t pc) {
+  if (!track_miss_pcs) return;
+  miss_pcs[pc]++;
+}
+
+void chipyard_simif_t::dump_stats(FILE* f, int hartid) {
+  uint64_t icache_accesses = stats.icache_hits + stats.icache_misses;
+  uint64_t dcache_misses = stats.dcache_misses[NToB] + stats.dcache_misses[NToT] + stats.dcache_misses[BToT];
+  uint64_t dcache_accesses = stats.dcache_load_hits + stats.dcache_store_hits + dcache_misses;
+  fprintf(f, "SpikeTile %d stats at cycle %ld\n", hartid, cycle);
+  fprintf(f, "  icache hits         %ld\n", stats.icache_hits);
+  fprintf(f, "  icache misses       %ld (%.2f%%)\n", stats.icache_misses,
+          icache_accesses ? 100.0 * stats.icache_misses / icache_accesses : 0.0);
+  fprintf(f, "  dcache load hits    %ld\n", stats.dcache_load_hits);
+  fprintf(f, "  dcache store hits   %ld\n", stats.dcache_store_hits);
+  fprintf(f, "  dcache misses       %ld (%.2f%%) NToB %ld NToT %ld BToT %ld\n", dcache_misses,
+          dcache_accesses ? 100.0 * dcache_misses / dcache_accesses : 0.0,
+          stats.dcache_misses[NToB], stats.dcache_misses[NToT], stats.dcache_misses[BToT]);
+  fprintf(f, "  voluntary wbs       %ld\n", stats.voluntary_wbs);
+  fprintf(f, "  probes              %ld (%ld with data)\n", stats.probes, stats.probe_wbs);
+  fprintf(f, "  stq forwards        %ld\n", stats.stq_forwards);
+  fprintf(f, "  stq stalls          %ld\n", stats.stq_stalls);
+  fprintf(f, "  mmio accesses       %ld (%ld readonly hits)\n", stats.mmio_accesses, stats.mmio_readonly_hits);
+  fprintf(f, "  host switches       %ld (%ld stalled cycles skipped)\n", stats.host_switches, stats.skipped_switches);
+  fprintf(f, "  idle cycles         %ld\n", stats.idle_cycles);
+
+  if (track_miss_pcs && !miss_pcs.empty()) {
+    std::vector<std::pair<reg_t, uint64_t>> sorted(miss_pcs.begin(), miss_pcs.end());
+    std::sort(sorted.begin(), sorted.end(), [](auto& a, auto& b) { return a.second > b.second; });
+    size_t n = std::min(sorted.size(), (size_t)32);
+    fprintf(f, "  top %ld miss PCs\n", n);
+    for (size_t i = 0; i < n; i++) {
+      fprintf(f, "    %016lx %ld\n", sorted[i].first, sorted[i].second);
+    }
+  }
+  fflush(f);
+}
+
+bool chipyard_simif_t::quiescent() {
+  // The inflight tables hold one entry per source id, so check for a valid one
+  auto valid = [](const cache_miss_t& e) { return e.valid; };
+  return icache_miss_q.empty() && std::none_of(icache_inflight.begin(), icache_inflight.end(), valid) &&
+    dcache_miss_q.empty() && std::none_of(dcache_inflight.begin(), dcache_inflight.end(), valid) &&
+    wb_q.empty() && st_q.empty() &&
+    !mmio_valid && !mmio_inflight;
+}
+
+void chipyard_simif_t::set_replacement(repl_policy_t policy, uint64_t seed) {
+  icache_repl = cache_repl_t(policy, icache_sets, icache_ways, seed);
+  dcache_repl = cache_repl_t(policy, dcache_sets, dcache_ways, seed + 1);
+}
+
+cache_repl_t::cache_repl_t(repl_policy_t policy, size_t n_sets, size_t n_ways, uint64_t seed) :
+  policy(policy),
+  n_sets(n_sets),
+  n_ways(n_ways),
+  stride(policy == REPL_RANDOM ? 0 : n_ways)
+{
+  if (policy == REPL_PLRU && (n_ways & (n_ways - 1)) != 0) {
+    fprintf(stderr, "SpikeTile PLRU replacement requires a power-of-two number of ways\n");
+    abort();
+  }
+  if (policy == REPL_LRU && n_ways > 256) {
+    fprintf(stderr, "SpikeTile LRU replacement supports at most 256 ways\n");
+    abort();
+  }
+  meta.resize(n_sets * stride, 0);
+  if (policy == REPL_LRU) {
+    for (size_t s = 0; s < n_sets; s++)
+      for (size_t w = 0; w < n_ways; w++)
+        meta[s * stride + w] = w;
+  }
+
+  // splitmix64 the seed so that nearby seeds give unrelated streams, and
+  // xorshift never starts from the all-zeros state
+  uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  rng = z ^ (z >> 31);
+  if (rng == 0) rng = 1;
+}
+
+uint64_t cache_repl_t::next_random() {
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return rng;
+}
+
+void cache_repl_t::touch(size_t set, size_t way) {
+  uint8_t* m = meta.data() + set * stride;
+  switch (policy) {
+  case REPL_RANDOM:
+    break;
+  case REPL_LRU: {
+    // m[w] is the age of way w, 0 being most-recently-used
+    uint8_t age = m[way];
+    for (size_t w = 0; w < n_ways; w++) {
+      if (m[w] < age) m[w]++;
+    }
+    m[way] = 0;
+    break;
+  }
+  case REPL_PLRU: {
+    // Heap-ordered tree, node 1 is the root. Each node points at the
+    // less-recently-used half, so flip every node on the path away from way.
+    size_t node = 1;
+    for (size_t half = n_ways >> 1; half > 0; half >>= 1) {
+      bool right = way & half;
+      m[node] = !right;
+      node = 2 * node + right;
+    }
+    break;
+  }
+  }
+}
+
+size_t cache_repl_t::victim(size_t set) {
+  uint8_t* m = meta.data() + set * stride;
+  switch (policy) {
+  case REPL_LRU: {
+    size_t oldest = 0;
+    for (size_t w = 1; w < n_ways; w++) {
+      if (m[w] > m[oldest]) oldest = w;
+    }
+    return oldest;
+  }
+  case REPL_PLRU: {
+    size_t node = 1;
+    while (node < n_ways) {
+      node = 2 * node + m[node];
+    }
+    return node - n_ways;
+  }
+  case REPL_RANDOM:
+  default:
+    return next_random() % n_ways;
+  }
+}
+
+sampler_t::sampler_t(uint64_t skip, uint64_t settle, uint64_t window) :
+  skip(skip),
+  settle(settle),
+  window(window),
+  window_insns(0),
+  window_cycle(0),
+  window_stats()
+{
+  enter(SAMPLE_SKIP, window_stats, 0);
+}
+
+void sampler_t::enter(sample_phase_t p, const cache_stats_t& stats, uint64_t cycle) {
+  // Zero-length phases are skipped straight through
+  if (p == SAMPLE_SKIP && skip == 0)
+    p = SAMPLE_SETTLE;
+  if (p == SAMPLE_SETTLE && settle == 0)
+    p = SAMPLE_MEASURE;
+  phase = p;
+  remaining = p == SAMPLE_SKIP ? skip : p == SAMPLE_SETTLE ? settle : window;
+  if (p == SAMPLE_MEASURE) {
+    window_insns = 0;
+    window_cycle = cycle;
+    window_stats = stats;
+  }
+}
+
+void sampler_t::advance(const cache_stats_t& stats, uint64_t cycle, uint64_t retired) {
+  if (phase == SAMPLE_MEASURE)
+    window_insns += retired;
+  if (retired < remaining) {
+    remaining -= retired;
+    return;
+  }
+
+  switch (phase) {
+  case SAMPLE_SKIP:
+    enter(SAMPLE_SETTLE, stats, cycle);
+    break;
+  case SAMPLE_SETTLE:
+    enter(SAMPLE_MEASURE, stats, cycle);
+    break;
+  case SAMPLE_MEASURE: {
+    uint64_t ic_misses = stats.icache_misses - window_stats.icache_misses;
+    uint64_t ic_accesses = ic_misses + stats.icache_hits - window_stats.icache_hits;
+    uint64_t dc_misses = 0;
+    for (size_t i = 0; i < 3; i++)
+      dc_misses += stats.dcache_misses[i] - window_stats.dcache_misses[i];
+    uint64_t dc_accesses = dc_misses +
+      stats.dcache_load_hits - window_stats.dcache_load_hits +
+      stats.dcache_store_hits - window_stats.dcache_store_hits;
+    cpi.push_back((double)(cycle - window_cycle) / window_insns);
+    icache_miss_rate.push_back(ic_accesses ? (double)ic_misses / ic_accesses : 0.0);
+    dcache_miss_rate.push_back(dc_accesses ? (double)dc_misses / dc_accesses : 0.0);
+    enter(SAMPLE_SKIP, stats, cycle);
+    break;
+  }
+  }
+}
+
+// Mean, standard deviation and range over the windows. This describes how
+// the windows differ, not how far the mean is from the whole run's.
+static void sample_summary(FILE* f, const char* name, const std::vector<double>& v, double scale) {
+  double mean = 0, var = 0;
+  for (double x : v)
+    mean += x;
+  mean /= v.size();
+  for (double x : v)
+    var += (x - mean) * (x - mean);
+  double stddev = v.size() > 1 ? sqrt(var / (v.size() - 1)) : 0.0;
+  auto range = std::minmax_element(v.begin(), v.end());
+  fprintf(f, "  %-18s mean %.4f stddev %.4f min %.4f max %.4f\n", name,
+          mean * scale, stddev * scale, *range.first * scale, *range.second * scale);
+}
+
+void sampler_t::report(FILE* f, int hartid) {
+  fprintf(f, "SpikeTile %d measured %zu windows of %" PRIu64 " instructions (skip %" PRIu64 ", settle %" PRIu64 ")\n",
+          hartid, cpi.size(), window, skip, settle);
+  if (cpi.empty()) {
+    fprintf(f, "  no complete measurement windows\n");
+    fflush(f);
+    return;
+  }
+  sample_summary(f, "CPI", cpi, 1.0);
+  sample_summary(f, "icache miss rate %", icache_miss_rate, 100.0);
+  sample_summary(f, "dcache miss rate %", dcache_miss_rate, 100.0);
+  fflush(f);
+}
+
+// Indexed by major opcode, insn[6:2]
+static const uint8_t major_opcode_class[32] = {
+  IC_LOAD,   IC_LOAD,   IC_INT,    IC_SYSTEM, IC_INT,    IC_INT,   IC_INT,    IC_INT,
+  IC_STORE,  IC_STORE,  IC_INT,    IC_AMO,    IC_INT,    IC_INT,   IC_INT,    IC_INT,
+  IC_FP,     IC_FP,     IC_FP,     IC_FP,     IC_FP,     IC_VECTOR, IC_INT,   IC_INT,
+  IC_BRANCH, IC_BRANCH, IC_INT,    IC_BRANCH, IC_SYSTEM, IC_INT,   IC_INT,    IC_INT
+};
+
+// Indexed by {quadrant, funct3} of a compressed instruction
+static const uint8_t rvc_class[24] = {
+  IC_INT,    IC_LOAD,   IC_LOAD,   IC_LOAD,   IC_INT,    IC_STORE,  IC_STORE,  IC_STORE,
+  IC_INT,    IC_INT,    IC_INT,    IC_INT,    IC_INT,    IC_BRANCH, IC_BRANCH, IC_BRANCH,
+  IC_INT,    IC_LOAD,   IC_LOAD,   IC_LOAD,   IC_INT,    IC_STORE,  IC_STORE,  IC_STORE
+};
+
+static const char* insn_class_names[IC_COUNT] = {
+  "int", "branch", "mul", "div", "load", "store", "amo", "fp", "fdiv", "vector", "system"
+};
+
+timing_model_t::timing_model_t(const char* fname) :
+  last_rd(0),
+  last_stall(0)
+{
+  for (size_t i = 0; i < IC_COUNT; i++) {
+    issue[i] = CYCLE;
+    stall[i] = 0;
+  }
+
+  // Each line is "<class> <latency> <throughput>", '#' starts a comment
   std::ifstream in(fname);
-  std::string line;
   if (!in.is_open()) {
+    fprintf(stderr, "SpikeTile could not open timing table %s\n", fname);
+    abort();
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    std::stringstream ss(line);
+    std::string name;
+    double latency, throughput;
+    if (!(ss >> name))
+      continue;
+    if (!(ss >> latency >> throughput) || latency < 0 || throughput <= 0) {
+      fprintf(stderr, "SpikeTile malformed timing table line: %s\n", line.c_str());
+      abort();
+    }
+    size_t c = std::find(insn_class_names, insn_class_names + IC_COUNT, name) - insn_class_names;
+    if (c == IC_COUNT) {
+      fprintf(stderr, "SpikeTile unknown instruction class %s in timing table\n", name.c_str());
+      abort();
+    }
+    issue[c] = (int64_t)(CYCLE / throughput);
+    stall[c] = std::max((int64_t)(latency * CYCLE) - issue[c], (int64_t)0);
+  }
+}
+
+insn_class_t timing_model_t::classify(insn_bits_t bits) {
+  if ((bits & 3) != 3) {
+    return (insn_class_t)rvc_class[((bits & 3) << 3) | ((bits >> 13) & 7)];
+  }
+  uint32_t major = (bits >> 2) & 0x1f;
+  insn_class_t c = (insn_class_t)major_opcode_class[major];
+  switch (major) {
+  case 0x01: // LOAD-FP
+  case 0x09: { // STORE-FP, widths other than h/w/d/q are vector memory ops
+    uint32_t width = (bits >> 12) & 7;
+    return (width >= 1 && width <= 4) ? c : IC_VECTOR;
+  }
+  case 0x0c: // OP
+  case 0x0e: // OP-32
+    if (((bits >> 25) & 0x7f) == 1)
+      return ((bits >> 14) & 1) ? IC_DIV : IC_MUL;
+    return c;
+  case 0x14: { // OP-FP
+    uint32_t funct5 = (bits >> 27) & 0x1f;
+    return (funct5 == 0x03 || funct5 == 0x0b) ? IC_FDIV : c;
+  }
+  default:
+    return c;
+  }
+}
+
+int64_t timing_model_t::cost(insn_bits_t bits) {
+  insn_class_t c = classify(bits);
+  int64_t cycles = issue[c];
+  if ((bits & 3) == 3) {
+    uint32_t rs1 = (bits >> 15) & 0x1f;
+    uint32_t rs2 = (bits >> 20) & 0x1f;
+    if (last_rd && (rs1 == last_rd || rs2 == last_rd))
+      cycles += last_stall;
+    last_rd = (c == IC_STORE || c == IC_BRANCH) ? 0 : (bits >> 7) & 0x1f;
+  } else {
+    last_rd = 0;
+  }
+  last_stall = stall[c];
+  return cycles;
+}
+
+// Copy the PT_LOAD segments of a mapped ELF image into mem. Segments are
+// placed relative to the entry point, which is where the hex image made by
+// smartelf2hex.sh starts, so either form of +loadmem lands the same bytes.
+template <class ehdr_t, class phdr_t>
+static void load_elf_segments(const uint8_t* image, size_t fsize, uint8_t* mem, size_t mem_size)
+{
+  const ehdr_t* eh = (const ehdr_t*)image;
+  if (fsize < sizeof(ehdr_t) || eh->e_phoff + (uint64_t)eh->e_phnum * sizeof(phdr_t) > fsize) {
+    fprintf(stderr, "Loadmem ELF is truncated\n");
+    abort();
+  }
+  const phdr_t* ph = (const phdr_t*)(image + eh->e_phoff);
+  for (int i = 0; i < eh->e_phnum; i++) {
+    if (ph[i].p_type != PT_LOAD || ph[i].p_memsz == 0)
+      continue;
+    uint64_t base = ph[i].p_paddr;
+    uint64_t end = base + ph[i].p_memsz;
+    if (ph[i].p_filesz > ph[i].p_memsz || ph[i].p_offset + ph[i].p_filesz > fsize) {
+      fprintf(stderr, "Loadmem ELF is truncated\n");
+      abort();
+    }
+    // Anything below the entry point (e.g. headers mapped into the first
+    // segment) is not part of the image
+    uint64_t skip = base < eh->e_entry ? eh->e_entry - base : 0;
+    if (skip >= ph[i].p_memsz)
+      continue;
+    if (end - eh->e_entry > mem_size) {
+      fprintf(stderr, "Loadmem file is too large\n");
+      abort();
+    }
+    if (skip < ph[i].p_filesz)
+      memcpy(mem + base + skip - eh->e_entry, image + ph[i].p_offset + skip, ph[i].p_filesz - skip);
+  }
+}
+
+#define parse_nibble(c) ((c) >= 'a' ? (c)-'a'+10 : (c)-'0')
+void chipyard_simif_t::loadmem(const char* fname) {
+  int fd = open(fname, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
     printf("SpikeTile couldn't open loadmem file %s\n", fname);
     abort();
   }
+  unsigned char ident[EI_NIDENT] = {0};
+  if (st.st_size >= EI_NIDENT && pread(fd, ident, EI_NIDENT, 0) == EI_NIDENT &&
+      memcmp(ident, ELFMAG, SELFMAG) == 0) {
+    // ELF images are mapped rather than read, so large images cost only
+    // the pages actually copied
+    void* image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+      printf("SpikeTile couldn't map loadmem file %s\n", fname);
+      abort();
+    }
+    // Gaps and .bss read as zero, as they do in a hex image
+    memset(tcm, 0, tcm_size);
+    if (ident[EI_CLASS] == ELFCLASS64)
+      load_elf_segments<Elf64_Ehdr, Elf64_Phdr>((const uint8_t*)image, st.st_size, tcm, tcm_size);
+    else
+      load_elf_segments<Elf32_Ehdr, Elf32_Phdr>((const uint8_t*)image, st.st_size, tcm, tcm_size);
+    munmap(image, st.st_size);
+    return;
+  }
+  close(fd);
+
+  std::ifstream in(fname);
+  std::string line;
   size_t fsize = 0;
   size_t start = 0;
   while (std::getline(in, line)) {
@@ -1052,14 +1877,27 @@ void spike_thread_main(void* arg)
   state_t* state = proc->get_state();
   while (true) {
     while (tile->max_insns == 0) {
-      host->switch_to();
+      simif->yield_to_host();
     }
     while (tile->max_insns != 0) {
       // TODO: Fences don't work
       //uint64_t last_bits = proc->get_last_bits();
       // if (insn_should_fence(last_bits) && !simif->stq_empty()) {
-      //   host->switch_to();
+      //   simif->yield_to_host();
       // }
+      if (tile->timing && !(tile->sampler && tile->sampler->skipping())) {
+        if (tile->credit <= 0) {
+          tile->max_insns = 0;
+          break;
+        }
+        insn_bits_t bits = 0;
+        try {
+          bits = proc->get_mmu()->access_icache(state->pc)->data.insn.bits();
+        } catch (trap_t& t) {
+          // The fetch faults; step() takes the same trap below
+        }
+        tile->credit -= tile->timing->cost(bits);
+      }
       proc->step(1);
       tile->max_insns--;
       if (proc->is_waiting_for_interrupt()) {
@@ -1098,7 +1936,160 @@ void stq_thread_main(void* arg)
   tile->simif->drain_stq();
 }
 
-tile_t::tile_t(processor_t* p, chipyard_simif_t* s) : proc(p), simif(s), max_insns(0) {
+#if SPIKE_FAST_CONTEXT
+// spike_ctx_switch(void** from_sp, void* to_sp) pushes the callee-saved
+// state onto the current stack, stores the stack pointer to *from_sp, and
+// pops the same frame off to_sp. A fresh coroutine's frame "returns" into
+// spike_ctx_trampoline, which calls the entry function held in the frame.
+extern "C" void spike_ctx_switch(void** from_sp, void* to_sp);
+extern "C" void spike_ctx_trampoline();
+
+#if defined(__x86_64__)
+asm(R"(
+  .text
+  .globl spike_ctx_switch
+  .type spike_ctx_switch, @function
+spike_ctx_switch:
+  pushq %rbp
+  pushq %rbx
+  pushq %r12
+  pushq %r13
+  pushq %r14
+  pushq %r15
+  subq $8, %rsp
+  stmxcsr (%rsp)
+  fnstcw 4(%rsp)
+  movq %rsp, (%rdi)
+  movq %rsi, %rsp
+  ldmxcsr (%rsp)
+  fldcw 4(%rsp)
+  addq $8, %rsp
+  popq %r15
+  popq %r14
+  popq %r13
+  popq %r12
+  popq %rbx
+  popq %rbp
+  ret
+  .size spike_ctx_switch, .-spike_ctx_switch
+
+  .globl spike_ctx_trampoline
+  .type spike_ctx_trampoline, @function
+spike_ctx_trampoline:
+  movq %r13, %rdi
+  callq *%r12
+  ud2
+  .size spike_ctx_trampoline, .-spike_ctx_trampoline
+)");
+// Frame layout, lowest address first
+enum { CTX_CTRL, CTX_R15, CTX_R14, CTX_R13, CTX_R12, CTX_RBX, CTX_RBP, CTX_RET, CTX_WORDS };
+#define CTX_ENTRY CTX_R12
+#define CTX_ARG CTX_R13
+#elif defined(__aarch64__)
+asm(R"(
+  .text
+  .globl spike_ctx_switch
+  .type spike_ctx_switch, %function
+spike_ctx_switch:
+  sub sp, sp, #160
+  stp x19, x20, [sp, #0]
+  stp x21, x22, [sp, #16]
+  stp x23, x24, [sp, #32]
+  stp x25, x26, [sp, #48]
+  stp x27, x28, [sp, #64]
+  stp x29, x30, [sp, #80]
+  stp d8, d9, [sp, #96]
+  stp d10, d11, [sp, #112]
+  stp d12, d13, [sp, #128]
+  stp d14, d15, [sp, #144]
+  mov x2, sp
+  str x2, [x0]
+  mov sp, x1
+  ldp x19, x20, [sp, #0]
+  ldp x21, x22, [sp, #16]
+  ldp x23, x24, [sp, #32]
+  ldp x25, x26, [sp, #48]
+  ldp x27, x28, [sp, #64]
+  ldp x29, x30, [sp, #80]
+  ldp d8, d9, [sp, #96]
+  ldp d10, d11, [sp, #112]
+  ldp d12, d13, [sp, #128]
+  ldp d14, d15, [sp, #144]
+  add sp, sp, #160
+  ret
+  .size spike_ctx_switch, .-spike_ctx_switch
+
+  .globl spike_ctx_trampoline
+  .type spike_ctx_trampoline, %function
+spike_ctx_trampoline:
+  mov x0, x20
+  blr x19
+  brk #0
+  .size spike_ctx_trampoline, .-spike_ctx_trampoline
+)");
+enum { CTX_X19, CTX_X20, CTX_X29 = 10, CTX_X30, CTX_WORDS = 20 };
+#define CTX_ENTRY CTX_X19
+#define CTX_ARG CTX_X20
+#define CTX_RET CTX_X30
+#endif
+
+#define CTX_STACK_SIZE (8 << 20)
+
+void coroutine_t::init(void (*f)(void*), void* a) {
+  // Reserve a guard page below the stack so an overflow faults instead of
+  // silently corrupting the neighbouring coroutine
+  size_t page = sysconf(_SC_PAGESIZE);
+  char* base = (char*)mmap(nullptr, CTX_STACK_SIZE + page, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    fprintf(stderr, "SpikeTile couldn't allocate a coroutine stack\n");
+    abort();
+  }
+  mprotect(base, page, PROT_NONE);
+
+  // The trampoline runs with the stack 16-byte aligned at its call site
+  uintptr_t top = ((uintptr_t)(base + page + CTX_STACK_SIZE)) & ~(uintptr_t)15;
+#if defined(__x86_64__)
+  uint64_t* frame = (uint64_t*)(top - 24) - CTX_RET;
+  frame[CTX_CTRL] = 0x037f00001f80ULL; // default fpcw and mxcsr
+#else
+  uint64_t* frame = (uint64_t*)top - CTX_WORDS;
+  frame[CTX_X29] = 0;
+#endif
+  frame[CTX_ENTRY] = (uint64_t)f;
+  frame[CTX_ARG] = (uint64_t)a;
+  frame[CTX_RET] = (uint64_t)spike_ctx_trampoline;
+  sp = frame;
+}
+
+void coroutine_t::resume() {
+  spike_ctx_switch(&caller_sp, sp);
+}
+
+void coroutine_t::yield() {
+  spike_ctx_switch(&sp, caller_sp);
+}
+#else
+void coroutine_t::init(void (*f)(void*), void* a) {
+  ctx = new context_t();
+  ctx->init(f, a);
+}
+
+void coroutine_t::resume() {
+  caller = context_t::current();
+  ctx->switch_to();
+}
+
+void coroutine_t::yield() {
+  caller->switch_to();
+}
+#endif
+
+tile_t::tile_t(processor_t* p, chipyard_simif_t* s) : proc(p), simif(s), max_insns(0),
+                                                      spike_stalled(false), spike_epoch(0),
+                                                      stq_stalled(false), stq_epoch(0),
+                                                      idle(false), idle_irqs(0), idle_epoch(0),
+                                                      timing(nullptr), credit(0), sampler(nullptr) {
   spike_context.init(spike_thread_main, this);
   stq_context.init(stq_thread_main, this);
 }
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vpi_user.h>
+#include <svdpi.h>
+
+// Counters for TraceCounterMonitor. With +trace-counters=FILE, each hart
+// appends one JSON object per line to FILE every +trace-counters-interval
+// cycles (default 0: only at the end of the run). The last line for each
+// hart has "final": true. The counter CSRs are not sampled: csr_reads only
+// holds the last value software read from each one with csrr, if any.
+
+static bool counters_configured = false;
+static FILE* counters_file = NULL;
+static uint64_t counters_interval = 0;
+// hartid -> csr -> last value read
+static std::map<int, std::map<int, uint64_t>> counter_csrs;
+// Monitors of different harts may be evaluated on different threads
+static std::mutex counters_lock;
+
+static std::string csr_name(int csr)
+{
+  int n = csr & 0x1f;
+  bool machine = (csr & 0xf00) == 0xb00;
+  if (n == 0)
+    return machine ? "mcycle" : "cycle";
+  if (n == 1)
+    return "time";
+  if (n == 2)
+    return machine ? "minstret" : "instret";
+  return (machine ? "mhpmcounter" : "hpmcounter") + std::to_string(n);
+}
+
+static void close_counters_file()
+{
+  fclose(counters_file);
+}
+
+static void configure_counters()
+{
+  counters_configured = true;
+  s_vpi_vlog_info vinfo;
+  if (!vpi_get_vlog_info(&vinfo))
+    abort();
+  const char* fname = NULL;
+  for (int i = 1; i < vinfo.argc; i++) {
+    std::string arg(vinfo.argv[i]);
+    if (arg.find("+trace-counters=") == 0) {
+      fname = vinfo.argv[i] + strlen("+trace-counters=");
+    }
+    if (arg.find("+trace-counters-interval=") == 0) {
+      counters_interval = strtoull(vinfo.argv[i] + strlen("+trace-counters-interval="), NULL, 10);
+    }
+  }
+  if (!fname)
+    return;
+  counters_file = fopen(fname, "w");
+  if (!counters_file) {
+    fprintf(stderr, "TraceCounters: unable to open %s\n", fname);
+    abort();
+  }
+  atexit(close_counters_file);
+}
+
+extern "C" void trace_counters_init(long long int hartid,
+                                    unsigned char* enable,
+                                    long long int* interval)
+{
+  std::lock_guard<std::mutex> guard(counters_lock);
+  if (!counters_configured)
+    configure_counters();
+  *enable = counters_file != NULL;
+  *interval = counters_interval;
+}
+
+extern "C" void trace_counters_csr(long long int hartid, int csr, long long int value)
+{
+  std::lock_guard<std::mutex> guard(counters_lock);
+  counter_csrs[hartid][csr] = value;
+}
+
+extern "C" void trace_counters_sample(long long int hartid,
+                                      long long int cycle,
+                                      long long int instret,
+                                      long long int loads,
+                                      long long int stores,
+                                      long long int branches,
+                                      long long int jumps,
+                                      long long int vector,
+                                      long long int exceptions,
+                                      long long int interrupts,
+                                      unsigned char is_final)
+{
+  std::lock_guard<std::mutex> guard(counters_lock);
+  fprintf(counters_file,
+          "{\"hartid\": %lld, \"final\": %s, \"cycle\": %lld, \"instret\": %lld, \"ipc\": %.4f, "
+          "\"loads\": %lld, \"stores\": %lld, \"branches\": %lld, \"jumps\": %lld, \"vector\": %lld, "
+          "\"exceptions\": %lld, \"interrupts\": %lld, \"csr_reads\": {",
+          hartid, is_final ? "true" : "false", cycle, instret,
+          cycle ? (double)instret / cycle : 0.0,
+          loads, stores, branches, jumps, vector, exceptions, interrupts);
+  const char* sep = "";
+  for (auto& csr : counter_csrs[hartid]) {
+    fprintf(counters_file, "%s\"%s\": %lu", sep, csr_name(csr.first).c_str(), csr.second);
+    sep = ", ";
+  }
+  fprintf(counters_file, "}}\n");
+  if (is_final)
+    fflush(counters_file);
+}
@@ -53,12 +53,18 @@ module SpikeCosim  #(
 					 input [63:0] trace_1_wdata
 					 );
 
-   initial begin
-      cospike_set_sysinfo(ISA, PMPREGIONS, MEM0_BASE, MEM0_SIZE, NHARTS, BOOTROM);
-   end;
+   bit initialized;
 
    always @(posedge clock) begin
-      if (!reset) begin
+      if (reset) begin
+	 // Set up out of reset rather than in an initial block, so a model
+	 // restored from a +reset-snapshot sets up again
+	 initialized = 1'b0;
+      end else begin
+	 if (!initialized) begin
+	    cospike_set_sysinfo(ISA, PMPREGIONS, MEM0_BASE, MEM0_SIZE, NHARTS, BOOTROM);
+	    initialized = 1'b1;
+	 end
 	 if (trace_0_valid || trace_0_exception || trace_0_cause) begin
 	    cospike_cosim(cycle, hartid, trace_0_has_wdata, trace_0_valid, trace_0_iaddr,
 			  trace_0_insn, trace_0_exception, trace_0_interrupt, trace_0_cause,
@@ -0,0 +1,61 @@
+import "DPI-C" function void perf_regions_init(input  longint hartid,
+                                               output bit     enable,
+                                               output longint start_pc,
+                                               output longint end_pc
+                                               );
+
+import "DPI-C" function void perf_regions_mark(input longint hartid,
+                                               input longint cycle,
+                                               input longint instret,
+                                               input bit     is_end
+                                               );
+
+
+// Watches the retired-instruction trace for the region start/end PCs.
+// The comparison is done here, so the DPI is only called at region
+// boundaries rather than for every retired instruction.
+module PerfRegionMonitor #(
+                           parameter HARTID) (
+                                              input        clock,
+                                              input        reset,
+
+                                              input [63:0] cycle,
+
+                                              input        trace_0_valid,
+                                              input [63:0] trace_0_iaddr,
+
+                                              input        trace_1_valid,
+                                              input [63:0] trace_1_iaddr
+                                              );
+
+   bit     initialized;
+   bit     enable;
+   longint start_pc;
+   longint end_pc;
+   reg [63:0] instret;
+
+   wire hit_0 = enable && trace_0_valid && (trace_0_iaddr == start_pc || trace_0_iaddr == end_pc);
+   wire hit_1 = enable && trace_1_valid && (trace_1_iaddr == start_pc || trace_1_iaddr == end_pc);
+
+   always @(posedge clock) begin
+      if (reset) begin
+         instret <= 64'b0;
+         // Set up out of reset rather than in an initial block, so a model
+         // restored from a +reset-snapshot sets up again
+         initialized = 1'b0;
+         enable = 1'b0;
+      end else if (!initialized) begin
+         perf_regions_init(HARTID, enable, start_pc, end_pc);
+         initialized = 1'b1;
+      end else begin
+         instret <= instret + trace_0_valid + trace_1_valid;
+         // instret counts the instructions retired before the marker
+         if (hit_0) begin
+            perf_regions_mark(HARTID, cycle, instret, trace_0_iaddr == end_pc);
+         end
+         if (hit_1) begin
+            perf_regions_mark(HARTID, cycle, instret + trace_0_valid, trace_1_iaddr == end_pc);
+         end
+      end
+   end
+endmodule; // PerfRegionMonitor
@@ -0,0 +1,160 @@
+import "DPI-C" function void trace_counters_init(input  longint hartid,
+                                                 output bit     enable,
+                                                 output longint interval
+                                                 );
+
+import "DPI-C" function void trace_counters_csr(input longint hartid,
+                                                input int     csr,
+                                                input longint value
+                                                );
+
+import "DPI-C" function void trace_counters_sample(input longint hartid,
+                                                   input longint cycle,
+                                                   input longint instret,
+                                                   input longint loads,
+                                                   input longint stores,
+                                                   input longint branches,
+                                                   input longint jumps,
+                                                   input longint vector,
+                                                   input longint exceptions,
+                                                   input longint interrupts,
+                                                   input bit     is_final
+                                                   );
+
+
+// Counts retired instructions by class from the trace port, and reports
+// them every INTERVAL cycles (from +trace-counters-interval) and at the end
+// of the run. The counter CSRs themselves are not visible here; only the
+// values software reads from them with csrr are forwarded, as they retire.
+module TraceCounterMonitor #(
+                             parameter HARTID) (
+                                                input        clock,
+                                                input        reset,
+
+                                                input [63:0] cycle,
+
+                                                input        trace_0_valid,
+                                                input [31:0] trace_0_insn,
+                                                input        trace_0_exception,
+                                                input        trace_0_interrupt,
+                                                input        trace_0_has_wdata,
+                                                input [63:0] trace_0_wdata,
+
+                                                input        trace_1_valid,
+                                                input [31:0] trace_1_insn,
+                                                input        trace_1_exception,
+                                                input        trace_1_interrupt,
+                                                input        trace_1_has_wdata,
+                                                input [63:0] trace_1_wdata
+                                                );
+
+   localparam LOAD = 0;
+   localparam STORE = 1;
+   localparam BRANCH = 2;
+   localparam JUMP = 3;
+   localparam VECTOR = 4;
+
+   // Instruction classes of a (possibly compressed) instruction.
+   // AMOs count as both a load and a store.
+   function [4:0] classify(input [31:0] insn);
+      begin
+         classify = 5'b0;
+         if (insn[1:0] != 2'b11) begin
+            case ({insn[1:0], insn[15:13]})
+              5'b00_001, 5'b00_010, 5'b00_011,
+              5'b10_001, 5'b10_010, 5'b10_011: classify[LOAD] = 1'b1;
+              5'b00_101, 5'b00_110, 5'b00_111,
+              5'b10_101, 5'b10_110, 5'b10_111: classify[STORE] = 1'b1;
+              5'b01_110, 5'b01_111:            classify[BRANCH] = 1'b1;
+              5'b01_101:                       classify[JUMP] = 1'b1;
+              // c.jr / c.jalr
+              5'b10_100:                       classify[JUMP] = insn[6:2] == 5'b0 && insn[11:7] != 5'b0;
+              default: ;
+            endcase
+         end else begin
+            case (insn[6:0])
+              7'h03: classify[LOAD] = 1'b1;
+              7'h07: begin
+                 classify[LOAD] = 1'b1;
+                 classify[VECTOR] = insn[14:12] == 3'd0 || insn[14:12] >= 3'd5;
+              end
+              7'h23: classify[STORE] = 1'b1;
+              7'h27: begin
+                 classify[STORE] = 1'b1;
+                 classify[VECTOR] = insn[14:12] == 3'd0 || insn[14:12] >= 3'd5;
+              end
+              7'h2f: classify[STORE:LOAD] = 2'b11;
+              7'h57: classify[VECTOR] = 1'b1;
+              7'h63: classify[BRANCH] = 1'b1;
+              7'h67, 7'h6f: classify[JUMP] = 1'b1;
+              default: ;
+            endcase
+         end
+      end
+   endfunction
+
+   // csrr* of mcycle/minstret/mhpmcounterN or their user-mode shadows
+   function is_counter_read(input [31:0] insn);
+      begin
+         is_counter_read = insn[6:0] == 7'h73 && insn[14:12] != 3'd0 &&
+                           (insn[31:25] == 7'b1011000 || insn[31:25] == 7'b1100000);
+      end
+   endfunction
+
+   bit     initialized;
+   bit     enable;
+   longint interval;
+   reg [63:0] instret, loads, stores, branches, jumps, vector, exceptions, interrupts;
+   reg [63:0] next_sample;
+
+   wire [4:0] class_0 = trace_0_valid ? classify(trace_0_insn) : 5'b0;
+   wire [4:0] class_1 = trace_1_valid ? classify(trace_1_insn) : 5'b0;
+
+   always @(posedge clock) begin
+      if (reset) begin
+         instret <= 64'b0;
+         loads <= 64'b0;
+         stores <= 64'b0;
+         branches <= 64'b0;
+         jumps <= 64'b0;
+         vector <= 64'b0;
+         exceptions <= 64'b0;
+         interrupts <= 64'b0;
+         // Set up out of reset rather than in an initial block, so a model
+         // restored from a +reset-snapshot sets up again
+         initialized = 1'b0;
+         enable = 1'b0;
+      end else if (!initialized) begin
+         trace_counters_init(HARTID, enable, interval);
+         next_sample <= cycle + interval;
+         initialized = 1'b1;
+      end else if (enable) begin
+         instret <= instret + trace_0_valid + trace_1_valid;
+         loads <= loads + class_0[LOAD] + class_1[LOAD];
+         stores <= stores + class_0[STORE] + class_1[STORE];
+         branches <= branches + class_0[BRANCH] + class_1[BRANCH];
+         jumps <= jumps + class_0[JUMP] + class_1[JUMP];
+         vector <= vector + class_0[VECTOR] + class_1[VECTOR];
+         exceptions <= exceptions + trace_0_exception + trace_1_exception;
+         interrupts <= interrupts + trace_0_interrupt + trace_1_interrupt;
+         if (trace_0_valid && trace_0_has_wdata && is_counter_read(trace_0_insn)) begin
+            trace_counters_csr(HARTID, {20'b0, trace_0_insn[31:20]}, trace_0_wdata);
+         end
+         if (trace_1_valid && trace_1_has_wdata && is_counter_read(trace_1_insn)) begin
+            trace_counters_csr(HARTID, {20'b0, trace_1_insn[31:20]}, trace_1_wdata);
+         end
+         if (interval != 0 && cycle >= next_sample) begin
+            trace_counters_sample(HARTID, cycle, instret, loads, stores, branches, jumps,
+                                  vector, exceptions, interrupts, 1'b0);
+            next_sample <= cycle + interval;
+         end
+      end
+   end
+
+   final begin
+      if (enable) begin
+         trace_counters_sample(HARTID, cycle, instret, loads, stores, branches, jumps,
+                               vector, exceptions, interrupts, 1'b1);
+      end
+   end
+endmodule; // TraceCounterMonitor
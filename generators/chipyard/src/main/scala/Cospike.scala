@@ -31,6 +31,7 @@ class SpikeCosim(cfg: SpikeCosimConfig) extends BlackBox(Map(
 )) with HasBlackBoxResource
 {
   addResource("/csrc/cospike.cc")
+  addResource("/csrc/harness_profile.h")
   addResource("/vsrc/cospike.v")
   val io = IO(new Bundle {
     val clock = Input(Clock())
@@ -371,6 +371,18 @@ class WithCospike extends ComposeHarnessBinder({
   }
 })
 
+class WithPerfRegions extends ComposeHarnessBinder({
+  (system: CanHaveTraceIOModuleImp, th: HasHarnessSignalReferences, ports: Seq[TraceOutputTop]) => {
+    ports.map { p => p.traces.zipWithIndex.map(t => PerfRegionMonitor(t._1, t._2)) }
+  }
+})
+
+class WithTraceCounters extends ComposeHarnessBinder({
+  (system: CanHaveTraceIOModuleImp, th: HasHarnessSignalReferences, ports: Seq[TraceOutputTop]) => {
+    ports.map { p => p.traces.zipWithIndex.map(t => TraceCounterMonitor(t._1, t._2)) }
+  }
+})
+
 
 class WithCustomBootPinPlusArg extends OverrideHarnessBinder({
   (system: CanHavePeripheryCustomBootPin, th: HasHarnessSignalReferences, ports: Seq[Bool]) => {
@@ -0,0 +1,50 @@
+package chipyard
+
+import chisel3._
+import chisel3.experimental.{IntParam, IO}
+import chisel3.util._
+
+import testchipip.TileTraceIO
+
+class PerfRegionMonitor(hartid: Int) extends BlackBox(Map(
+  "HARTID" -> IntParam(hartid)
+)) with HasBlackBoxResource
+{
+  addResource("/csrc/perfregions.cc")
+  addResource("/vsrc/perfregions.v")
+  val io = IO(new Bundle {
+    val clock = Input(Clock())
+    val reset = Input(Bool())
+    val cycle = Input(UInt(64.W))
+    val trace = Input(Vec(2, new Bundle {
+      val valid = Bool()
+      val iaddr = UInt(64.W)
+    }))
+  })
+}
+
+object PerfRegionMonitor
+{
+  def apply(trace: TileTraceIO, hartid: Int) = {
+    val monitor = Module(new PerfRegionMonitor(hartid))
+    val cycle = withClockAndReset(trace.clock, trace.reset) {
+      val r = RegInit(0.U(64.W))
+      r := r + 1.U
+      r
+    }
+    monitor.io.clock := trace.clock
+    monitor.io.reset := trace.reset
+    require(trace.numInsns <= 2)
+    monitor.io.cycle := cycle
+    monitor.io.trace.map(t => {
+      t.valid := false.B
+      t.iaddr := 0.U
+    })
+    for (i <- 0 until trace.numInsns) {
+      monitor.io.trace(i).valid := trace.insns(i).valid
+      val signed = Wire(SInt(64.W))
+      signed := trace.insns(i).iaddr.asSInt
+      monitor.io.trace(i).iaddr := signed.asUInt
+    }
+  }
+}
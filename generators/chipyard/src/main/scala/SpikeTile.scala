@@ -155,14 +155,14 @@ class SpikeTile(
         resources = device.reg,
         regionType = RegionType.IDEMPOTENT, // not cacheable
         executable = true,
-        supportsGet = TransferSizes(1, 8),
-        supportsPutFull = TransferSizes(1, 8),
-        supportsPutPartial = TransferSizes(1, 8),
+        supportsGet = TransferSizes(1, p(CacheBlockBytes)),
+        supportsPutFull = TransferSizes(1, p(CacheBlockBytes)),
+        supportsPutPartial = TransferSizes(1, p(CacheBlockBytes)),
         fifoId = Some(0)
       )),
-      beatBytes = 8
+      beatBytes = tcmP.beatBytes
     )))
-    connectTLSlave(tcmNode := TLBuffer(), 8)
+    connectTLSlave(tcmNode := TLBuffer(), p(CacheBlockBytes))
     tcmNode
   }
 
@@ -189,7 +189,8 @@ class SpikeBlackBox(
   readonly_uncacheable_regions: String,
   executable_regions: String,
   tcm_base: BigInt,
-  tcm_size: BigInt) extends BlackBox(Map(
+  tcm_size: BigInt,
+  tcm_beat_bytes: Int) extends BlackBox(Map(
     "HARTID" -> IntParam(hartId),
     "ISA" -> StringParam(isa),
     "PMPREGIONS" -> IntParam(pmpregions),
@@ -204,7 +205,8 @@ class SpikeBlackBox(
     "CACHEABLE" -> StringParam(cacheable_regions),
     "EXECUTABLE" -> StringParam(executable_regions),
     "TCM_BASE" -> IntParam(tcm_base),
-    "TCM_SIZE" -> IntParam(tcm_size)
+    "TCM_SIZE" -> IntParam(tcm_size),
+    "TCM_BEAT_BYTES" -> IntParam(tcm_beat_bytes)
   )) with HasBlackBoxResource {
 
   val io = IO(new Bundle {
@@ -231,7 +233,7 @@ class SpikeBlackBox(
       val d = new Bundle {
         val valid = Input(Bool())
         val sourceid = Input(UInt(64.W))
-        val data = Input(Vec(8, UInt(64.W)))
+        val data = Input(UInt(512.W))
       }
     }
 
@@ -258,12 +260,12 @@ class SpikeBlackBox(
         val param = Output(UInt(32.W))
         val voluntary = Output(Bool())
         val has_data = Output(Bool())
-        val data = Output(Vec(8, UInt(64.W)))
+        val data = Output(UInt(512.W))
       }
       val d = new Bundle {
         val valid = Input(Bool())
         val sourceid = Input(UInt(64.W))
-        val data = Input(Vec(8, UInt(64.W)))
+        val data = Input(UInt(512.W))
         val has_data = Input(Bool())
         val grantack = Input(Bool())
       }
@@ -288,20 +290,25 @@ class SpikeBlackBox(
       val a = new Bundle {
         val valid = Input(Bool())
         val address = Input(UInt(64.W))
-        val data = Input(UInt(64.W))
-        val mask = Input(UInt(32.W))
+        val sourceid = Input(UInt(64.W))
+        val data = Input(UInt(512.W))
+        val mask = Input(UInt(64.W))
         val opcode = Input(UInt(32.W))
         val size = Input(UInt(32.W))
       }
       val d = new Bundle {
         val valid = Output(Bool())
         val ready = Input(Bool())
-        val data = Output(UInt(64.W))
+        val sourceid = Output(UInt(64.W))
+        val size = Output(UInt(32.W))
+        val has_data = Output(Bool())
+        val data = Output(UInt(512.W))
       }
     }
   })
   addResource("/vsrc/spiketile.v")
   addResource("/csrc/spiketile.cc")
+  addResource("/csrc/harness_profile.h")
 
 }
 
@@ -332,7 +339,8 @@ class SpikeTileModuleImp(outer: SpikeTile) extends BaseTileModuleImp(outer) {
     tileParams.dcache.get.nMSHRs,
     cacheable_regions, uncacheable_regions, readonly_uncacheable_regions, executable_regions,
     outer.spikeTileParams.tcmParams.map(_.base).getOrElse(0),
-    outer.spikeTileParams.tcmParams.map(_.size).getOrElse(0)
+    outer.spikeTileParams.tcmParams.map(_.size).getOrElse(0),
+    outer.spikeTileParams.tcmParams.map(_.beatBytes).getOrElse(8)
   ))
   spike.io.clock := clock.asBool
   val cycle = RegInit(0.U(64.W))
@@ -360,7 +368,7 @@ class SpikeTileModuleImp(outer: SpikeTile) extends BaseTileModuleImp(outer) {
   icache_tl.d.ready := true.B
   spike.io.icache.d.valid := icache_tl.d.valid
   spike.io.icache.d.sourceid := icache_tl.d.bits.source
-  spike.io.icache.d.data := icache_tl.d.bits.data.asTypeOf(Vec(8, UInt(64.W)))
+  spike.io.icache.d.data := icache_tl.d.bits.data
 
   spike.io.dcache.a.ready := dcache_tl.a.ready
   dcache_tl.a.valid := spike.io.dcache.a.valid
@@ -388,14 +396,14 @@ class SpikeTileModuleImp(outer: SpikeTile) extends BaseTileModuleImp(outer) {
         toAddress = spike.io.dcache.c.address,
         lgSize = blockBits.U,
         shrinkPermissions = spike.io.dcache.c.param,
-        data = spike.io.dcache.c.data.asUInt)._2,
+        data = spike.io.dcache.c.data)._2,
       Mux(spike.io.dcache.c.has_data,
         dcacheEdge.ProbeAck(
           fromSource = spike.io.dcache.c.sourceid,
           toAddress = spike.io.dcache.c.address,
           lgSize = blockBits.U,
           reportPermissions = spike.io.dcache.c.param,
-          data = spike.io.dcache.c.data.asUInt),
+          data = spike.io.dcache.c.data),
         dcacheEdge.ProbeAck(
           fromSource = spike.io.dcache.c.sourceid,
           toAddress = spike.io.dcache.c.address,
@@ -414,7 +422,7 @@ class SpikeTileModuleImp(outer: SpikeTile) extends BaseTileModuleImp(outer) {
   spike.io.dcache.d.has_data := has_data
   spike.io.dcache.d.grantack := dcache_tl.d.bits.opcode.isOneOf(TLMessages.Grant, TLMessages.GrantData)
   spike.io.dcache.d.sourceid := dcache_tl.d.bits.source
-  spike.io.dcache.d.data := dcache_tl.d.bits.data.asTypeOf(Vec(8, UInt(64.W)))
+  spike.io.dcache.d.data := dcache_tl.d.bits.data
 
   dcache_tl.e.valid := dcache_tl.d.valid && should_finish
   dcache_tl.e.bits := dcacheEdge.GrantAck(dcache_tl.d.bits)
@@ -440,18 +448,19 @@ class SpikeTileModuleImp(outer: SpikeTile) extends BaseTileModuleImp(outer) {
     tcm_tl.a.ready := true.B
     spike.io.tcm.a.valid := tcm_tl.a.valid
     spike.io.tcm.a.address := tcm_tl.a.bits.address
+    spike.io.tcm.a.sourceid := tcm_tl.a.bits.source
     spike.io.tcm.a.data := tcm_tl.a.bits.data
     spike.io.tcm.a.mask := tcm_tl.a.bits.mask
     spike.io.tcm.a.opcode := tcm_tl.a.bits.opcode
     spike.io.tcm.a.size := tcm_tl.a.bits.size
 
+    // Responses, including every beat of a Get burst, come back from the
+    // TCM model with their own source and size
     spike.io.tcm.d.ready := tcm_tl.d.ready
-    tcm_tl.d.bits := tcmEdge.AccessAck(RegNext(tcm_tl.a.bits))
-    when (RegNext(tcm_tl.a.bits.opcode === TLMessages.Get)) {
-      tcm_tl.d.bits.opcode := TLMessages.AccessAckData
-    }
     tcm_tl.d.valid := spike.io.tcm.d.valid
-    tcm_tl.d.bits.data := spike.io.tcm.d.data
+    tcm_tl.d.bits := Mux(spike.io.tcm.d.has_data,
+      tcmEdge.AccessAck(spike.io.tcm.d.sourceid, spike.io.tcm.d.size, spike.io.tcm.d.data),
+      tcmEdge.AccessAck(spike.io.tcm.d.sourceid, spike.io.tcm.d.size))
   }
 }
 
@@ -470,13 +479,14 @@ class WithNSpikeCores(n: Int = 1, tileParams: SpikeTileParams = SpikeTileParams(
   }
 })
 
-class WithSpikeTCM extends Config((site, here, up) => {
+class WithSpikeTCM(beatBytes: Option[Int] = None) extends Config((site, here, up) => {
   case TilesLocated(InSubsystem) => {
     val prev = up(TilesLocated(InSubsystem))
     require(prev.size == 1)
     val spike = prev(0).asInstanceOf[SpikeTileAttachParams]
+    val master = up(ExtMem).get.master
     Seq(spike.copy(tileParams = spike.tileParams.copy(
-      tcmParams = Some(up(ExtMem).get.master)
+      tcmParams = Some(master.copy(beatBytes = beatBytes.getOrElse(master.beatBytes)))
     )))
   }
   case ExtMem => None
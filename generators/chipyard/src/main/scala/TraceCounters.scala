@@ -0,0 +1,60 @@
+package chipyard
+
+import chisel3._
+import chisel3.experimental.{IntParam, IO}
+import chisel3.util._
+
+import testchipip.TileTraceIO
+
+class TraceCounterMonitor(hartid: Int) extends BlackBox(Map(
+  "HARTID" -> IntParam(hartid)
+)) with HasBlackBoxResource
+{
+  addResource("/csrc/tracecounters.cc")
+  addResource("/vsrc/tracecounters.v")
+  val io = IO(new Bundle {
+    val clock = Input(Clock())
+    val reset = Input(Bool())
+    val cycle = Input(UInt(64.W))
+    val trace = Input(Vec(2, new Bundle {
+      val valid = Bool()
+      val insn = UInt(32.W)
+      val exception = Bool()
+      val interrupt = Bool()
+      val has_wdata = Bool()
+      val wdata = UInt(64.W)
+    }))
+  })
+}
+
+object TraceCounterMonitor
+{
+  def apply(trace: TileTraceIO, hartid: Int) = {
+    val monitor = Module(new TraceCounterMonitor(hartid))
+    val cycle = withClockAndReset(trace.clock, trace.reset) {
+      val r = RegInit(0.U(64.W))
+      r := r + 1.U
+      r
+    }
+    monitor.io.clock := trace.clock
+    monitor.io.reset := trace.reset
+    require(trace.numInsns <= 2)
+    monitor.io.cycle := cycle
+    monitor.io.trace.map(t => {
+      t.valid := false.B
+      t.insn := 0.U
+      t.exception := false.B
+      t.interrupt := false.B
+      t.has_wdata := false.B
+      t.wdata := 0.U
+    })
+    for (i <- 0 until trace.numInsns) {
+      monitor.io.trace(i).valid := trace.insns(i).valid
+      monitor.io.trace(i).insn := trace.insns(i).insn
+      monitor.io.trace(i).exception := trace.insns(i).exception
+      monitor.io.trace(i).interrupt := trace.insns(i).interrupt
+      monitor.io.trace(i).has_wdata := trace.insns(i).wdata.isDefined.B
+      monitor.io.trace(i).wdata := trace.insns(i).wdata.getOrElse(0.U)
+    }
+  }
+}
@@ -21,6 +21,13 @@ def get_cycle_from_log(log_file, pc_value):
     except subprocess.CalledProcessError:  # grep found nothing
         return "NA"
 
+def get_cycles_from_regions(regions_file):
+    # Written by the simulator with PERF_REGIONS=1; no log or ELF scan needed
+    with open(regions_file, newline="") as f:
+        for row in csv.DictReader(f):
+            return row["start_cycle"], row["end_cycle"]
+    return "NA", "NA"
+
 def main(perf_tests_path, logs_path, output_file):
     log_files = [f for f in os.listdir(logs_path) if f.endswith('.log')]
     
@@ -30,6 +37,12 @@ def main(perf_tests_path, logs_path, output_file):
         
         for log in log_files:
             test_base_name = os.path.splitext(log)[0]
+            regions_file = os.path.join(logs_path, f"{test_base_name}.perf.csv")
+            if os.path.exists(regions_file):
+                start_cycle, end_cycle = get_cycles_from_regions(regions_file)
+                writer.writerow([test_base_name, start_cycle, end_cycle])
+                continue
+
             elf_path = os.path.join(perf_tests_path, f"{test_base_name}.elf")
             exe_path = os.path.join(perf_tests_path, f"{test_base_name}.exe")
 
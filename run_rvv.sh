@@ -9,8 +9,6 @@ if [ "$#" -lt 1 ]; then
   exit 1
 fi
 
-# Now run the make command for each elf file
-for ELF_FILE in "$@"; do
-  make -C sims/vcs run-binary-debug-hex CONFIG=SmallBobcatConfig BINARY=/root/my-chipyard/"$ELF_FILE" SIM_FLAGS="+cosim"
-done
-
+# Run all elf files concurrently on one simulator build
+make -C sims/vcs run-regression-debug CONFIG=SmallBobcatConfig SIM_FLAGS="+cosim" \
+  REGRESSION_BINARIES="${*/#//root/my-chipyard/}"
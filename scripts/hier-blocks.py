@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Pick the modules to Verilate as hierarchy blocks (--hierarchical) from the
+# module hierarchy firtool exported for the DUT. A module is picked if its
+# name matches one of the patterns and it is instantiated at least
+# --min-instances times, which after firtool's dedup means identical tiles
+# that can share one compiled class. Writes a Verilator config file with a
+# hier_block line for each.
+#============================================================================
+
+import argparse
+import collections
+import fnmatch
+import json
+
+def count_instances(tree, counts):
+    for child in tree["instances"]:
+        counts[child["module_name"]] += 1
+        count_instances(child, counts)
+
+def main():
+    parser = argparse.ArgumentParser(description="Write Verilator hier_block configuration for repeated modules.")
+    parser.add_argument("--hier-json", required=True, help="module hierarchy JSON exported by firtool")
+    parser.add_argument("--patterns", default="*Tile", help="module name globs to consider")
+    parser.add_argument("--min-instances", type=int, default=2,
+                        help="only modules instantiated at least this many times")
+    parser.add_argument("--out", required=True, help="Verilator config file to write")
+    args = parser.parse_args()
+
+    with open(args.hier_json) as f:
+        tree = json.load(f)
+    counts = collections.Counter()
+    count_instances(tree, counts)
+
+    patterns = args.patterns.split()
+    blocks = sorted(m for m, n in counts.items()
+                    if n >= args.min_instances and any(fnmatch.fnmatchcase(m, p) for p in patterns))
+    with open(args.out, "w") as f:
+        f.write("`verilator_config\n")
+        for m in blocks:
+            f.write('hier_block -module "{}"\n'.format(m))
+
+    if blocks:
+        for m in blocks:
+            print("Hierarchy block: {} ({} instances)".format(m, counts[m]))
+    else:
+        print("[WARN] No module matching '{}' is instantiated {} or more times; "
+              "--hierarchical will not share any code".format(args.patterns, args.min_instances))
+
+if __name__ == "__main__":
+    main()
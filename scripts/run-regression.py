@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Run a list of binaries against one already-built simulator, several at a
+# time, and collect the results in a CSV. Normally invoked through the
+# `run-regression` / `run-regression-debug` make targets, which build the
+# simulator once and pass its full command line in --sim.
+#
+# - every job runs in its own directory under --out-dir (logs, waveforms,
+#   checkpoints and cosim files do not collide)
+# - with --loadmem hex|elf each binary is also preloaded with +loadmem;
+#   hex images are converted inside the job, so conversion runs in parallel.
+#   Those plusargs go between --sim and --sim-end, so a --sim-end of
+#   +permissive-off keeps them inside the permissive window
+# - stderr goes through spike-dasm into the job's .out, as with run-binary
+# - with --numa, jobs are spread round-robin over the NUMA nodes reported
+#   by `numactl -H` (the same parsing as scripts/numa_prefix) and each is
+#   pinned to its node's cpus and memory
+# - a job passes if the simulator exits 0, prints no "*** FAILED ***" and,
+#   with --expect, prints something matching the given regex
+#============================================================================
+
+import argparse
+import concurrent.futures
+import csv
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+base_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+def numa_nodes():
+    """Return a list of (node id, cpu list) from `numactl -H`, or []."""
+    if shutil.which("numactl") is None:
+        return []
+    out = subprocess.run(["numactl", "-H"], stdout=subprocess.PIPE,
+                         universal_newlines=True).stdout
+    nodes = []
+    for line in out.split("\n"):
+        cpu_match = re.match(r"^ *node (\d+) cpus: (\d.*\d)$", line)
+        if cpu_match:
+            nodes.append((cpu_match.group(1), cpu_match.group(2).replace(" ", ",")))
+    return nodes
+
+def job_name(binary, used):
+    """A unique, filesystem-friendly name for the job running binary."""
+    name = os.path.basename(binary)
+    n = 1
+    while name in used:
+        n += 1
+        name = "{}.{}".format(os.path.basename(binary), n)
+    used.add(name)
+    return name
+
+def run_sim(cmd, cwd, log, out, timeout):
+    """Run cmd with stdout in log and stderr disassembled into out."""
+    if shutil.which("spike-dasm") is None:
+        return subprocess.run(cmd, cwd=cwd, stdin=subprocess.DEVNULL,
+                              stdout=log, stderr=out, timeout=timeout).returncode
+    sim = subprocess.Popen(cmd, cwd=cwd, stdin=subprocess.DEVNULL,
+                           stdout=log, stderr=subprocess.PIPE)
+    dasm = subprocess.Popen(["spike-dasm"], stdin=sim.stderr, stdout=out)
+    sim.stderr.close()
+    try:
+        ret = sim.wait(timeout=timeout)
+    except subprocess.TimeoutExpired:
+        sim.kill()
+        sim.wait()
+        raise
+    finally:
+        dasm.wait()
+    return ret
+
+def run_job(binary, name, args, sim_cmd, sim_end, numa_queue, numa_lock):
+    job_dir = os.path.join(args.out_dir, name)
+    os.makedirs(job_dir, exist_ok=True)
+    log_path = os.path.join(job_dir, name + ".log")
+    out_path = os.path.join(job_dir, name + ".out")
+    start = time.time()
+
+    cmd = list(sim_cmd)
+    if args.loadmem == "hex":
+        image = os.path.join(job_dir, name + ".loadmem_hex")
+        with open(image, "w") as f, open(out_path, "w") as out:
+            conv = subprocess.run([os.path.join(base_dir, "scripts", "smartelf2hex.sh"), binary],
+                                  stdout=f, stderr=out)
+        if conv.returncode != 0:
+            open(log_path, "w").close()
+            return {"binary": binary, "status": "FAIL", "exit_code": "smartelf2hex",
+                    "cycles": "", "wall_s": "{:.2f}".format(time.time() - start), "log": out_path}
+        cmd += ["+loadmem=" + image, "+testfile=" + binary]
+    elif args.loadmem == "elf":
+        cmd += ["+loadmem=" + binary, "+testfile=" + binary]
+    cmd += sim_end + [binary]
+
+    node = None
+    if numa_queue is not None:
+        with numa_lock:
+            node = numa_queue.pop(0)
+        cmd = ["numactl", "-m", node[0], "-C", node[1], "--"] + cmd
+
+    try:
+        with open(log_path, "w") as log, open(out_path, "w") as out:
+            ret = run_sim(cmd, job_dir, log, out, args.timeout)
+    except subprocess.TimeoutExpired:
+        ret = "timeout"
+    finally:
+        if node is not None:
+            with numa_lock:
+                numa_queue.append(node)
+    wall = time.time() - start
+
+    with open(log_path, errors="replace") as log, open(out_path, errors="replace") as out:
+        text = log.read() + out.read()
+    cycles = ""
+    cycle_match = re.findall(r"after (\d+) cycles", text)
+    if cycle_match:
+        cycles = cycle_match[-1]
+    passed = (ret == 0 and "*** FAILED ***" not in text and
+              (args.expect is None or re.search(args.expect, text) is not None))
+    return {
+        "binary": binary,
+        "status": "PASS" if passed else "FAIL",
+        "exit_code": ret,
+        "cycles": cycles,
+        "wall_s": "{:.2f}".format(wall),
+        "log": log_path,
+    }
+
+def main():
+    parser = argparse.ArgumentParser(description="Run binaries concurrently on one simulator build.")
+    parser.add_argument("--sim", required=True,
+                        help="simulator command line (binary and flags) shared by all jobs")
+    parser.add_argument("--sim-end", default="",
+                        help="flags placed after each job's own plusargs, before the binary")
+    parser.add_argument("--jobs", "-j", type=int, default=os.cpu_count(),
+                        help="simulators to run at once (default: number of cpus)")
+    parser.add_argument("--out-dir", required=True, help="directory for per-job outputs")
+    parser.add_argument("--csv", help="results file (default: OUT_DIR/results.csv)")
+    parser.add_argument("--loadmem", choices=["none", "hex", "elf"], default="none",
+                        help="also preload each binary with +loadmem")
+    parser.add_argument("--numa", action="store_true",
+                        help="pin jobs round-robin to NUMA nodes with numactl")
+    parser.add_argument("--expect", help="regex the simulator output must match to pass")
+    parser.add_argument("--timeout", type=float, help="wall-clock limit per job in seconds")
+    parser.add_argument("--list", "-l", help="file with one binary per line")
+    parser.add_argument("binaries", nargs="*")
+    args = parser.parse_args()
+
+    binaries = list(args.binaries)
+    if args.list:
+        with open(args.list) as f:
+            binaries += [l.strip() for l in f if l.strip() and not l.startswith("#")]
+    if not binaries:
+        sys.exit("[ERROR] No binaries given")
+    binaries = [os.path.abspath(b) for b in binaries]
+    args.out_dir = os.path.abspath(args.out_dir)
+    os.makedirs(args.out_dir, exist_ok=True)
+    csv_path = args.csv or os.path.join(args.out_dir, "results.csv")
+    jobs = max(1, args.jobs)
+
+    numa_queue = None
+    numa_lock = threading.Lock()
+    if args.numa:
+        nodes = numa_nodes()
+        if nodes:
+            # one slot per job, interleaved across nodes
+            numa_queue = [nodes[i % len(nodes)] for i in range(jobs)]
+
+    sim_cmd = shlex.split(args.sim)
+    sim_end = shlex.split(args.sim_end)
+    used = set()
+    names = [job_name(b, used) for b in binaries]
+    with concurrent.futures.ThreadPoolExecutor(max_workers=jobs) as pool:
+        futures = [pool.submit(run_job, b, n, args, sim_cmd, sim_end, numa_queue, numa_lock)
+                   for b, n in zip(binaries, names)]
+        for future in concurrent.futures.as_completed(futures):
+            r = future.result()
+            print("[{}] {} ({} s, {} cycles)".format(r["status"], r["binary"], r["wall_s"],
+                                                     r["cycles"] or "?"), flush=True)
+    results = [future.result() for future in futures]
+    with open(csv_path, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=["binary", "status", "exit_code", "cycles", "wall_s", "log"])
+        writer.writeheader()
+        writer.writerows(results)
+
+    failed = [r for r in results if r["status"] != "PASS"]
+    print("{} passed, {} failed, results in {}".format(len(results) - len(failed), len(failed), csv_path))
+    for r in failed:
+        print("  FAILED: {} (see {})".format(r["binary"], r["log"]))
+    sys.exit(1 if failed else 0)
+
+if __name__ == "__main__":
+    main()
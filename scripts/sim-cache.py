@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Content-addressed cache of built simulators. Normally driven by the
+# Verilator makefile when SIM_CACHE=1.
+#
+# The key hashes an inputs file written by make: "var NAME=VALUE" lines for
+# the config and build settings, and "file PATH" lines for every source the
+# build reads (generator Scala/Verilog, build definitions, harness C++).
+# An entry holds the config's build directory (elaborated FIRRTL, generated
+# Verilog and Verilated C++, without object files) and the simulators built
+# from it.
+#
+#   sync   before make decides what to rebuild: if the build directory
+#          already matches the key, re-date it so touched-but-unchanged
+#          sources do not trigger a rebuild; otherwise restore a cached
+#          entry for the key, if there is one
+#   store  after a simulator is built: save it and the build directory
+#============================================================================
+
+import argparse
+import hashlib
+import json
+import os
+import shutil
+import sys
+import tarfile
+import tempfile
+import time
+
+STAMP = ".sim-cache-key"
+# left out of entries: objects are rebuilt (through ccache) if ever needed,
+# and tuning/pgo builds have their own directories
+EXCLUDE_SUFFIXES = (".o", ".a", ".d", ".gcda", ".profraw")
+EXCLUDE_DIRS = (".autotune", ".pgo")
+
+def file_digests(paths, memo_path):
+    """sha256 of each path, reusing digests of files whose size and mtime are unchanged."""
+    try:
+        with open(memo_path) as f:
+            memo = json.load(f)
+    except (OSError, ValueError):
+        memo = {}
+    digests = {}
+    changed = False
+    for path in paths:
+        try:
+            st = os.stat(path)
+        except OSError:
+            digests[path] = "missing"
+            continue
+        known = memo.get(path)
+        if known and known[0] == st.st_mtime_ns and known[1] == st.st_size:
+            digests[path] = known[2]
+            continue
+        h = hashlib.sha256()
+        with open(path, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                h.update(chunk)
+        digests[path] = h.hexdigest()
+        memo[path] = [st.st_mtime_ns, st.st_size, digests[path]]
+        changed = True
+    if changed:
+        fd, tmp = tempfile.mkstemp(dir=os.path.dirname(memo_path))
+        with os.fdopen(fd, "w") as f:
+            json.dump(memo, f)
+        os.replace(tmp, memo_path)
+    return digests
+
+def cache_key(args):
+    settings = []
+    paths = []
+    with open(args.inputs) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("var "):
+                settings.append(line[4:])
+            elif line.startswith("file "):
+                paths.extend(line[5:].split())
+    paths = sorted(set(paths))
+    digests = file_digests(paths, os.path.join(args.cache_dir, "digests.json"))
+    h = hashlib.sha256()
+    for s in settings:
+        h.update(("var " + s + "\n").encode())
+    for p in paths:
+        # relative to the repository, so checkouts in different places share entries
+        h.update("file {} {}\n".format(os.path.relpath(p, args.base_dir), digests[p]).encode())
+    return h.hexdigest()[:24], paths
+
+def read_stamps(build_dir):
+    """The key each simulator in build_dir was built from."""
+    try:
+        with open(os.path.join(build_dir, STAMP)) as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return {}
+
+def write_stamps(build_dir, stamps):
+    with open(os.path.join(build_dir, STAMP), "w") as f:
+        json.dump(stamps, f)
+
+def redate(paths, skip=()):
+    """Give every output the same, current mtime so make sees them as up to date."""
+    now = time.time()
+    skip = [os.path.abspath(p) for p in skip]
+    for path in paths:
+        if os.path.isdir(path):
+            for root, dirs, files in os.walk(path):
+                dirs[:] = [d for d in dirs if os.path.abspath(os.path.join(root, d)) not in skip]
+                for name in files:
+                    try:
+                        os.utime(os.path.join(root, name), (now, now), follow_symlinks=False)
+                    except OSError:
+                        pass
+        elif os.path.exists(path):
+            os.utime(path, (now, now))
+
+def newest(paths):
+    t = 0
+    for p in paths:
+        try:
+            t = max(t, os.stat(p).st_mtime)
+        except OSError:
+            pass
+    return t
+
+def binaries(args):
+    """(name, simulator, model directory) of each simulator make knows about."""
+    return [b for b in (("sim", args.sim, args.model_dir), ("sim-debug", args.sim_debug, args.model_dir_debug))
+            if b[1]]
+
+def sync(args):
+    key, inputs = cache_key(args)
+    entry = os.path.join(args.cache_dir, key)
+    stamps = read_stamps(args.build_dir)
+    current = [b for b in binaries(args) if stamps.get(b[0]) == key and os.path.exists(b[1])]
+    if current:
+        # a simulator built from other sources keeps its old dates, and its
+        # model is left alone so make still re-verilates it when asked to
+        stale = [b[2] for b in binaries(args) if b not in current and b[2]]
+        if newest(inputs) > min(os.stat(b[1]).st_mtime for b in current):
+            redate([args.build_dir] + [b[1] for b in current], skip=stale)
+            print("current")
+        else:
+            print("up-to-date")
+        return
+    if not os.path.exists(os.path.join(entry, "build.tar.gz")):
+        print("miss")
+        return
+    shutil.rmtree(args.build_dir, ignore_errors=True)
+    os.makedirs(args.build_dir)
+    with tarfile.open(os.path.join(entry, "build.tar.gz")) as tar:
+        if hasattr(tarfile, "data_filter"):
+            tar.extractall(args.build_dir, filter="data")
+        else:
+            tar.extractall(args.build_dir)
+    restored = []
+    stamps = {}
+    for name, path, model_dir in binaries(args):
+        cached = os.path.join(entry, name)
+        if os.path.exists(cached):
+            shutil.copy2(cached, path)
+            restored.append(path)
+            stamps[name] = key
+        elif model_dir:
+            # the entry may carry a half-built or older model for this one
+            shutil.rmtree(model_dir, ignore_errors=True)
+    write_stamps(args.build_dir, stamps)
+    redate([args.build_dir] + restored)
+    os.utime(entry)
+    print("hit")
+
+def keep(tarinfo):
+    if tarinfo.name.endswith(EXCLUDE_SUFFIXES) or tarinfo.name.split("/")[0].endswith(EXCLUDE_DIRS):
+        return None
+    return tarinfo
+
+def store(args):
+    key, _ = cache_key(args)
+    entry = os.path.join(args.cache_dir, key)
+    os.makedirs(entry, exist_ok=True)
+    stamps = {name: k for name, k in read_stamps(args.build_dir).items() if k == key}
+    stamps[args.name] = key
+    write_stamps(args.build_dir, stamps)
+    fd, tmp = tempfile.mkstemp(dir=entry)
+    os.close(fd)
+    with tarfile.open(tmp, "w:gz", compresslevel=1) as tar:
+        for name in sorted(os.listdir(args.build_dir)):
+            tar.add(os.path.join(args.build_dir, name), arcname=name, filter=keep)
+    os.replace(tmp, os.path.join(entry, "build.tar.gz"))
+    shutil.copy2(args.binary, os.path.join(entry, args.name))
+    prune(args)
+    print("Stored {} in the simulator cache as {}".format(os.path.basename(args.binary), key))
+
+def prune(args):
+    entries = [os.path.join(args.cache_dir, e) for e in os.listdir(args.cache_dir)]
+    entries = sorted((e for e in entries if os.path.isdir(e)), key=os.path.getmtime, reverse=True)
+    for e in entries[args.max_entries:]:
+        shutil.rmtree(e, ignore_errors=True)
+
+def main():
+    parser = argparse.ArgumentParser(description="Cache built simulators by config and source hash.")
+    parser.add_argument("command", choices=["sync", "store"])
+    parser.add_argument("--cache-dir", required=True)
+    parser.add_argument("--inputs", required=True, help="inputs file written by make")
+    parser.add_argument("--base-dir", required=True, help="repository root")
+    parser.add_argument("--build-dir", required=True, help="the config's generated-src directory")
+    parser.add_argument("--sim", help="path of the simulator")
+    parser.add_argument("--sim-debug", help="path of the debug simulator")
+    parser.add_argument("--model-dir", help="Verilator model directory of the simulator")
+    parser.add_argument("--model-dir-debug", help="Verilator model directory of the debug simulator")
+    parser.add_argument("--binary", help="store: the simulator just built")
+    parser.add_argument("--name", choices=["sim", "sim-debug"], help="store: which simulator it is")
+    parser.add_argument("--max-entries", type=int, default=8, help="entries to keep, most recently used first")
+    args = parser.parse_args()
+
+    os.makedirs(args.cache_dir, exist_ok=True)
+    if args.command == "sync":
+        sync(args)
+    else:
+        if not args.binary or not args.name:
+            sys.exit("[ERROR] store needs --binary and --name")
+        store(args)
+
+if __name__ == "__main__":
+    main()
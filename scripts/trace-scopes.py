@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Expand instance-path globs into the hierarchy prefixes the Verilator
+# harness takes with +trace-scope, using the module hierarchies firtool
+# exported for the test harness and the DUT. Paths are dotted instance
+# names from the harness down, e.g. TestHarness.chiptop0.system.tile_prci_domain;
+# '*' also matches across levels, so '*vector*' finds any instance whose
+# path mentions vector. Prints the comma-separated prefixes, dropping any
+# already covered by a shorter one.
+#============================================================================
+
+import argparse
+import fnmatch
+import json
+import sys
+
+def graft(tree, dut, dut_tree):
+    """Hang the DUT hierarchy under the DUT instance of the harness hierarchy."""
+    if tree["module_name"] == dut and not tree["instances"]:
+        tree["instances"] = dut_tree["instances"]
+    for child in tree["instances"]:
+        graft(child, dut, dut_tree)
+
+def paths(tree, prefix):
+    path = prefix + "." + tree["instance_name"] if prefix else tree["module_name"]
+    yield path
+    for child in tree["instances"]:
+        yield from paths(child, path)
+
+def main():
+    parser = argparse.ArgumentParser(description="Expand +trace-scope globs against the module hierarchy.")
+    parser.add_argument("--model-hier-json", required=True, help="harness hierarchy JSON exported by firtool")
+    parser.add_argument("--top-hier-json", required=True, help="DUT hierarchy JSON exported by firtool")
+    parser.add_argument("--dut", required=True, help="name of the DUT module")
+    parser.add_argument("globs", nargs="+")
+    args = parser.parse_args()
+
+    with open(args.model_hier_json) as f:
+        model = json.load(f)
+    with open(args.top_hier_json) as f:
+        graft(model, args.dut, json.load(f))
+
+    scopes = []
+    for path in paths(model, ""):
+        if any(fnmatch.fnmatchcase(path, g) for g in args.globs) and \
+           not any(path.startswith(s + ".") for s in scopes):
+            scopes.append(path)
+    if not scopes:
+        sys.exit("[ERROR] No instance matches {}".format(" ".join(args.globs)))
+    print(",".join(scopes))
+
+if __name__ == "__main__":
+    main()
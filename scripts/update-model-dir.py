@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Move a fresh Verilator output directory over the previous one, keeping the
+# old copy (and its timestamp) of every file whose contents did not change.
+# Used by the Verilator makefile with VERILATOR_INCREMENTAL=1, so that the
+# model's make only recompiles the C++ files Verilator actually changed.
+# Object and dependency files of the previous build are kept, except for
+# sources Verilator no longer generates.
+#============================================================================
+
+import filecmp
+import os
+import shutil
+import sys
+
+# what Verilator writes; anything else (objects, the compiler's .d files,
+# archives) belongs to the previous C++ build
+GENERATED = (".cpp", ".h", ".mk", ".dat", ".vlt")
+
+def merge(new_dir, model_dir):
+    """Merge new_dir into model_dir, returning (changed, total, removed) counts."""
+    os.makedirs(model_dir, exist_ok=True)
+    new_files = set(os.listdir(new_dir))
+    changed = total = removed = 0
+    for name in sorted(new_files):
+        src = os.path.join(new_dir, name)
+        dst = os.path.join(model_dir, name)
+        if os.path.isdir(src):
+            # hierarchy blocks (--hierarchical) are built in subdirectories
+            c, t, r = merge(src, dst)
+            changed, total, removed = changed + c, total + t, removed + r
+            continue
+        total += 1
+        if os.path.isfile(dst) and filecmp.cmp(src, dst, shallow=False):
+            continue
+        os.replace(src, dst)
+        changed += 1
+
+    for name in sorted(os.listdir(model_dir)):
+        base, ext = os.path.splitext(name)
+        if name in new_files or ext not in GENERATED:
+            continue
+        os.remove(os.path.join(model_dir, name))
+        removed += 1
+        if ext == ".cpp":
+            for product in (base + ".o", base + ".d"):
+                if os.path.exists(os.path.join(model_dir, product)):
+                    os.remove(os.path.join(model_dir, product))
+    return changed, total, removed
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: update-model-dir.py NEW_DIR MODEL_DIR")
+    new_dir, model_dir = sys.argv[1:]
+    changed, total, removed = merge(new_dir, model_dir)
+    shutil.rmtree(new_dir)
+    print("{}: {} of {} generated files changed, {} removed".format(model_dir, changed, total, removed))
+
+if __name__ == "__main__":
+    main()
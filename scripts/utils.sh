@@ -53,3 +53,32 @@ function restore_bash_options
 {
     set +vx; eval "$OLDSTATE"
 }
+
+#######################################
+# Run binaries concurrently on one
+# simulator build of a config with
+# `make run-regression`, exiting on any
+# failure. A job passes only if the
+# simulator reached $finish in
+# TestDriver.v.
+# Globals:
+#   CYDIR
+# Arguments:
+#   simulator (verilator, vcs, ...)
+#   make target (run-regression or
+#     run-regression-debug)
+#   config
+#   binaries
+#######################################
+function run_suite
+{
+    local sim=$1 target=$2 config=$3
+    shift 3
+    echo "Running $# binaries on $config"
+    if ! make -C $CYDIR/sims/$sim $target CONFIG=$config SIM_FLAGS=+cosim \
+           REGRESSION_EXPECT=TestDriver.v REGRESSION_BINARIES="$*"; then
+        echo "*******************FAILED*******************"
+        echo "See sims/$sim/output/*$config/regression*/results.csv"
+        exit 1
+    fi
+}
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Build the Verilator simulator of one config at several VERILATOR_THREADS
+# and VERILATOR_OUTPUT_SPLIT settings, run the same binary on each with
+# +profile, and record the simulated cycles per second. Normally invoked
+# through the `verilator-autotune` make target in sims/verilator.
+#
+# - every build goes to its own model directory and simulator under
+#   --out-dir, so the default simulator is left alone and builds that
+#   already exist are reused on a re-run
+# - results go to OUT_DIR/autotune.csv, and the fastest setting to
+#   OUT_DIR/preset.mk, which the Verilator makefile picks up with
+#   VERILATOR_USE_AUTOTUNE=1
+# - the binary should be short but representative; +max-cycles (through
+#   --sim-flags) bounds a run without losing its measurement
+#============================================================================
+
+import argparse
+import csv
+import os
+import re
+import shlex
+import subprocess
+import sys
+import time
+
+def build(args, threads, split):
+    """Build one simulator variant, returning its path or None on failure."""
+    name = "t{}-s{}".format(threads, split)
+    sim = os.path.join(args.out_dir, "simulator-" + name)
+    model_dir = os.path.join(args.out_dir, "model-" + name)
+    cmd = shlex.split(args.make) + [
+        "VERILATOR_THREADS={}".format(threads),
+        "VERILATOR_OUTPUT_SPLIT={}".format(split),
+        "VERILATOR_USE_AUTOTUNE=0",
+        "SIM_CACHE=0",
+        "sim=" + sim,
+        "model_dir=" + model_dir,
+        sim,
+    ]
+    log_path = os.path.join(args.out_dir, name + ".build.log")
+    print("[BUILD] {} (log in {})".format(name, log_path), flush=True)
+    start = time.time()
+    with open(log_path, "w") as log:
+        ret = subprocess.run(cmd, stdin=subprocess.DEVNULL, stdout=log, stderr=subprocess.STDOUT).returncode
+    if ret != 0:
+        print("[BUILD] {} failed".format(name), flush=True)
+        return None, time.time() - start
+    return sim, time.time() - start
+
+def measure(args, sim, threads, split):
+    """Run the binary on sim, returning (cycles, seconds, cycles/s) of the best repeat."""
+    name = "t{}-s{}".format(threads, split)
+    best = None
+    for i in range(args.repeat):
+        out_path = os.path.join(args.out_dir, "{}.run{}.out".format(name, i))
+        cmd = [sim] + shlex.split(args.sim_flags) + ["+profile", args.binary]
+        with open(out_path, "w") as out:
+            subprocess.run(cmd, cwd=args.out_dir, stdin=subprocess.DEVNULL,
+                           stdout=subprocess.DEVNULL, stderr=out)
+        with open(out_path, errors="replace") as out:
+            match = re.search(r"\*\*\* PROFILE \*\*\* (\d+) cycles in ([\d.]+) s \(([\d.]+) cycles/s\)",
+                              out.read())
+        if not match:
+            print("[RUN] {} printed no profile (see {})".format(name, out_path), flush=True)
+            return None
+        run = (int(match.group(1)), float(match.group(2)), float(match.group(3)))
+        if best is None or run[2] > best[2]:
+            best = run
+    return best
+
+def main():
+    parser = argparse.ArgumentParser(description="Pick Verilator thread and output-split settings by measurement.")
+    parser.add_argument("--make", required=True,
+                        help="make command line that builds the simulator of the config being tuned")
+    parser.add_argument("--binary", required=True, help="binary to benchmark with")
+    parser.add_argument("--sim-flags", default="", help="extra simulator flags for every run")
+    parser.add_argument("--threads", default="1 2 4 8", help="VERILATOR_THREADS values to try")
+    parser.add_argument("--splits", default="10000", help="VERILATOR_OUTPUT_SPLIT values to try")
+    parser.add_argument("--repeat", type=int, default=1, help="runs per build; the fastest is kept")
+    parser.add_argument("--out-dir", required=True, help="directory for builds, logs and results")
+    args = parser.parse_args()
+
+    args.out_dir = os.path.abspath(args.out_dir)
+    args.binary = os.path.abspath(args.binary)
+    args.repeat = max(1, args.repeat)
+    os.makedirs(args.out_dir, exist_ok=True)
+    if not os.path.exists(args.binary):
+        sys.exit("[ERROR] No binary " + args.binary)
+
+    ncpus = len(os.sched_getaffinity(0))
+    results = []
+    for split in args.splits.split():
+        for threads in args.threads.split():
+            if int(threads) > ncpus:
+                # an oversubscribed model spins and measures nothing useful
+                print("[SKIP] {} threads with only {} cpus".format(threads, ncpus), flush=True)
+                continue
+            sim, build_s = build(args, threads, split)
+            run = measure(args, sim, threads, split) if sim else None
+            row = {"threads": threads, "output_split": split, "build_s": "{:.1f}".format(build_s),
+                   "cycles": "", "run_s": "", "cycles_per_s": ""}
+            if run:
+                row.update({"cycles": run[0], "run_s": run[1], "cycles_per_s": run[2]})
+                print("[RUN] threads={} output_split={}: {:.1f} cycles/s".format(threads, split, run[2]),
+                      flush=True)
+            results.append(row)
+
+    csv_path = os.path.join(args.out_dir, "autotune.csv")
+    with open(csv_path, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=["threads", "output_split", "build_s",
+                                               "cycles", "run_s", "cycles_per_s"])
+        writer.writeheader()
+        writer.writerows(results)
+
+    measured = [r for r in results if r["cycles_per_s"] != ""]
+    if not measured:
+        sys.exit("[ERROR] No setting was measured, see the logs in " + args.out_dir)
+    best = max(measured, key=lambda r: r["cycles_per_s"])
+    preset_path = os.path.join(args.out_dir, "preset.mk")
+    with open(preset_path, "w") as f:
+        f.write("# written by verilator-autotune.py from {}\n".format(csv_path))
+        f.write("# {} cycles/s with {}\n".format(best["cycles_per_s"], os.path.basename(args.binary)))
+        f.write("VERILATOR_THREADS ?= {}\n".format(best["threads"]))
+        f.write("VERILATOR_OUTPUT_SPLIT ?= {}\n".format(best["output_split"]))
+    print("Best: VERILATOR_THREADS={} VERILATOR_OUTPUT_SPLIT={} ({:.1f} cycles/s)".format(
+        best["threads"], best["output_split"], best["cycles_per_s"]))
+    print("Results in {}, preset in {}".format(csv_path, preset_path))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+
+#============================================================================
+# Profile-guided build of the Verilator simulator. Normally invoked through
+# the `pgo` make target in sims/verilator, after the regular simulator has
+# been built:
+#
+# 1. run the training binaries on the regular simulator for a baseline
+# 2. build an instrumented simulator (PGO_STAGE=generate) and run the
+#    training binaries on it to collect the compiler profile (and, for a
+#    multithreaded model, Verilator's profile.vlt)
+# 3. rebuild with the profile (PGO_STAGE=use), in the same model directory
+#    so the profile matches up with the objects; each stage re-verilates
+#    from scratch, since the flags and output name are baked into the
+#    generated makefile
+# 4. run the training binaries again, report the speedup and install the
+#    result over the regular simulator
+#
+# Speed is taken from the +profile summary of the Verilator harness.
+#============================================================================
+
+import argparse
+import csv
+import glob
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+
+def build(args, stage, sim):
+    log_path = os.path.join(args.out_dir, stage + ".build.log")
+    print("[BUILD] {} (log in {})".format(stage, log_path), flush=True)
+    # an up-to-date model from the other stage would be reused as is
+    model_dir = os.path.join(args.out_dir, "model")
+    shutil.rmtree(model_dir, ignore_errors=True)
+    cmd = shlex.split(args.make) + [
+        "PGO_STAGE=" + stage,
+        # merging into the old model would keep objects built with the other stage's flags
+        "VERILATOR_INCREMENTAL=0",
+        "sim=" + sim,
+        "model_dir=" + model_dir,
+        sim,
+    ]
+    with open(log_path, "w") as log:
+        ret = subprocess.run(cmd, stdin=subprocess.DEVNULL, stdout=log, stderr=subprocess.STDOUT).returncode
+    if ret != 0 or not os.path.exists(sim):
+        sys.exit("[ERROR] {} build failed, see {}".format(stage, log_path))
+
+def run_all(args, stage, sim):
+    """Run every training binary on sim, returning a list of (cycles, seconds)."""
+    runs = []
+    for binary in args.binaries:
+        name = os.path.basename(binary)
+        out_path = os.path.join(args.out_dir, "{}.{}.out".format(stage, name))
+        cmd = [sim] + shlex.split(args.sim_flags) + ["+profile", binary]
+        # cwd is out_dir, where a --prof-pgo model leaves profile.vlt
+        with open(out_path, "w") as out:
+            ret = subprocess.run(cmd, cwd=args.out_dir, stdin=subprocess.DEVNULL,
+                                 stdout=subprocess.DEVNULL, stderr=out).returncode
+        with open(out_path, errors="replace") as out:
+            match = re.search(r"\*\*\* PROFILE \*\*\* (\d+) cycles in ([\d.]+) s", out.read())
+        if not match:
+            sys.exit("[ERROR] {} on the {} simulator printed no profile, see {}".format(name, stage, out_path))
+        if ret != 0:
+            print("[WARN] {} exited with {} on the {} simulator".format(name, ret, stage), flush=True)
+        runs.append((int(match.group(1)), float(match.group(2))))
+        print("[RUN] {} {}: {} cycles in {} s".format(stage, name, match.group(1), match.group(2)), flush=True)
+    return runs
+
+def merge_clang_profiles(data_dir):
+    """clang writes raw profiles that have to be merged before use; gcc needs nothing."""
+    raw = glob.glob(os.path.join(data_dir, "*.profraw"))
+    if not raw:
+        return
+    if shutil.which("llvm-profdata") is None:
+        sys.exit("[ERROR] clang profiles need llvm-profdata to merge them")
+    subprocess.run(["llvm-profdata", "merge", "-output=" + os.path.join(data_dir, "default.profdata")] + raw,
+                   check=True)
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the Verilator simulator with profile-guided optimization.")
+    parser.add_argument("--make", required=True,
+                        help="make command line that builds the simulator of the config")
+    parser.add_argument("--sim", required=True, help="the regular simulator, replaced by the PGO build")
+    parser.add_argument("--sim-flags", default="", help="extra simulator flags for every run")
+    parser.add_argument("--out-dir", required=True, help="directory for builds, profiles and the report")
+    parser.add_argument("--no-install", action="store_true", help="leave the regular simulator alone")
+    parser.add_argument("binaries", nargs="+", help="training binaries")
+    args = parser.parse_args()
+
+    args.out_dir = os.path.abspath(args.out_dir)
+    args.sim = os.path.abspath(args.sim)
+    args.binaries = [os.path.abspath(b) for b in args.binaries]
+    for b in args.binaries:
+        if not os.path.exists(b):
+            sys.exit("[ERROR] No training binary " + b)
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    base = run_all(args, "baseline", args.sim)
+
+    # stale counters from an earlier training set would skew the profile
+    data_dir = os.path.join(args.out_dir, "data")
+    shutil.rmtree(data_dir, ignore_errors=True)
+    vlt = os.path.join(args.out_dir, "profile.vlt")
+    if os.path.exists(vlt):
+        os.remove(vlt)
+    instrumented = os.path.join(args.out_dir, "simulator-instrumented")
+    build(args, "generate", instrumented)
+    run_all(args, "generate", instrumented)
+    merge_clang_profiles(data_dir)
+
+    optimized = os.path.join(args.out_dir, "simulator-pgo")
+    build(args, "use", optimized)
+    pgo = run_all(args, "use", optimized)
+
+    report = os.path.join(args.out_dir, "pgo-report.csv")
+    with open(report, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["binary", "cycles", "baseline_s", "pgo_s", "speedup"])
+        for b, (cycles, t0), (_, t1) in zip(args.binaries, base, pgo):
+            writer.writerow([b, cycles, t0, t1, "{:.3f}".format(t0 / t1 if t1 > 0 else 0.0)])
+    base_s = sum(t for _, t in base)
+    pgo_s = sum(t for _, t in pgo)
+    speedup = base_s / pgo_s if pgo_s > 0 else 0.0
+    print("Training set: " + " ".join(os.path.basename(b) for b in args.binaries))
+    print("Baseline {:.3f} s, PGO {:.3f} s: {:.2f}x speedup, details in {}".format(base_s, pgo_s, speedup, report))
+
+    if not args.no_install:
+        if speedup < 1.0:
+            print("[WARN] The PGO build is slower on the training set, not installing it")
+        else:
+            shutil.copy2(optimized, args.sim)
+            print("Installed the PGO build as " + args.sim)
+
+if __name__ == "__main__":
+    main()
@@ -1,62 +1,47 @@
 #!/bin/bash
 
-commands=(
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBoomConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc SIM_FLAGS=+cosim"
+# Each suite runs concurrently on one simulator build; see scripts/run-regression.py
 
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms1_vmv_vi.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms2_vse64.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms2p5_loadblock.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms3_vmv_xf.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms3p5_pureload.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4_vle64.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4p5_vle64_2.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4p6_vle32_2.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4p6_vle32_8.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4p7_vlnr_vsnr.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4p8_vlm.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms4p9_vl.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms5p1_vse64_m.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms5p2_vle64_m.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms5p3_stride_m.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms5p4_index.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/bringup_tests/ms5p5_index_mask.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/isg/riscv_vector_arithmetic_smoke_test.elf SIM_FLAGS=+cosim"
-  "make -C sims/verilator run-binary-hex CONFIG=SmallBobcatConfig BINARY=$PWD/tests/rvv/isg/riscv_vector_ms5_smoke_test.elf SIM_FLAGS=+cosim"
-)
+CYDIR=$(git rev-parse --show-toplevel)
 
-for cmd in "${commands[@]}"
-do
-  echo "Executing: $cmd"
-  output=$(eval $cmd 2>&1)
+# get helpful utilities
+source $CYDIR/scripts/utils.sh
 
-  # Extract the last lines of the output using `tail`
-  last_lines=$(echo "$output" | tail -10)
+isa_tests=(
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-lb"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-sb"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uf-p-ldst"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ud-p-ldst"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-add"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64ui-p-addi"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-mul"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64um-p-div"
+  "$RISCV/riscv64-unknown-elf/share/riscv-tests/isa/rv64uc-p-rvc"
+)
 
-  if [[ $last_lines != *"TestDriver.v"* ]]; then
-    echo "$output"
-    echo "*******************FAILED*******************"
-    echo "Expected '$finish' at the end of the printout, but it was not found."
-    echo "$cmd"
-    exit 1
-  fi
-done
+rvv_tests=(
+  "$PWD/tests/rvv/bringup_tests/ms1_vmv_vi.elf"
+  "$PWD/tests/rvv/bringup_tests/ms2_vse64.elf"
+  "$PWD/tests/rvv/bringup_tests/ms2p5_loadblock.elf"
+  "$PWD/tests/rvv/bringup_tests/ms3_vmv_xf.elf"
+  "$PWD/tests/rvv/bringup_tests/ms3p5_pureload.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4_vle64.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4p5_vle64_2.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4p6_vle32_2.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4p6_vle32_8.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4p7_vlnr_vsnr.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4p8_vlm.elf"
+  "$PWD/tests/rvv/bringup_tests/ms4p9_vl.elf"
+  "$PWD/tests/rvv/bringup_tests/ms5p1_vse64_m.elf"
+  "$PWD/tests/rvv/bringup_tests/ms5p2_vle64_m.elf"
+  "$PWD/tests/rvv/bringup_tests/ms5p3_stride_m.elf"
+  "$PWD/tests/rvv/bringup_tests/ms5p4_index.elf"
+  "$PWD/tests/rvv/bringup_tests/ms5p5_index_mask.elf"
+  "$PWD/tests/rvv/isg/riscv_vector_arithmetic_smoke_test.elf"
+  "$PWD/tests/rvv/isg/riscv_vector_ms5_smoke_test.elf"
+)
 
-echo "PASSED"
+run_suite verilator run-regression SmallBoomConfig "${isa_tests[@]}"
+run_suite verilator run-regression SmallBobcatConfig "${isa_tests[@]}" "${rvv_tests[@]}"
 
+echo "PASSED"
@@ -248,6 +248,14 @@ override SIM_FLAGS += +dramsim +dramsim_ini_dir=$(TESTCHIP_DIR)/src/main/resourc
 ifneq ($(LOADMEM),)
 override SIM_FLAGS += +loadmem=$(LOADMEM) +loadmem_addr=$(LOADMEM_ADDR)
 endif
+PERF_REGIONS ?= 0
+ifeq ($(PERF_REGIONS),1)
+override SIM_FLAGS += +perf-regions=$(sim_out_name).perf.csv
+endif
+TRACE_COUNTERS ?= 0
+ifeq ($(TRACE_COUNTERS),1)
+override SIM_FLAGS += +trace-counters=$(sim_out_name).counters.jsonl
+endif
 VERBOSE_FLAGS ?= +verbose
 sim_out_name = $(output_dir)/$(subst $() $(),_,$(notdir $(basename $(BINARY))))
 binary_hex= $(sim_out_name).loadmem_hex